@@ -0,0 +1,28 @@
+#include <stdint.h>
+
+#include "arena.h"
+
+void arena_init(arena_t* arena, size_t size)
+{
+    *arena = {};
+    arena->base = new unsigned char[size];
+    arena->size = size;
+}
+
+void arena_destroy(arena_t* arena)
+{
+    delete[] arena->base;
+    *arena = {};
+}
+
+void* arena_alloc(arena_t* arena, size_t size, size_t align)
+{
+    uintptr_t address = reinterpret_cast<uintptr_t>(arena->base) + arena->used;
+    size_t padding = (align - address % align) % align;
+    if(arena->used + padding + size > arena->size) return NULL;
+
+    void* allocation = arena->base + arena->used + padding;
+    arena->used += padding + size;
+    if(arena->used > arena->peak) arena->peak = arena->used;
+    return allocation;
+}
@@ -0,0 +1,40 @@
+#ifndef PONG_ARENA_H
+#define PONG_ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator over one block taken at init. Allocations are never freed one by one: a frame arena
+// is reset every frame, a persistent one lives as long as what it holds. Running out returns NULL
+// rather than growing, so the game loop never reaches the heap.
+typedef struct
+{
+    unsigned char* base;
+    size_t size;
+    size_t used;
+    size_t peak;
+} arena_t;
+
+void arena_init(arena_t* arena, size_t size);
+void arena_destroy(arena_t* arena);
+
+// size bytes aligned to align, a power of two, or NULL when the arena is full
+void* arena_alloc(arena_t* arena, size_t size, size_t align);
+
+template<typename T>
+T* arena_array(arena_t* arena, int count)
+{
+    return static_cast<T*>(arena_alloc(arena, sizeof(T) * count, alignof(T)));
+}
+
+inline void arena_reset(arena_t* arena)
+{
+    arena->used = 0;
+}
+
+// back to an earlier arena->used, releasing everything allocated since
+inline void arena_rewind(arena_t* arena, size_t used)
+{
+    arena->used = used;
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include "batch.h"
+#include "batch_kernels.h"
+
+void batch_init(match_batch_t* batch, int count, unsigned int seed)
+{
+    *batch = {};
+    batch->count = count;
+    batch->entity_count = count * 3;
+    batch->isa = simd_detect();
+
+    int entities = batch->entity_count;
+    batch->x = new float[entities]();
+    batch->y = new float[entities]();
+    batch->previous_x = new float[entities]();
+    batch->previous_y = new float[entities]();
+    batch->pixel_x = new int[entities]();
+    batch->pixel_y = new int[entities]();
+    batch->w = new int[entities]();
+    batch->h = new int[entities]();
+    batch->dir_x = new float[entities]();
+    batch->dir_y = new float[entities]();
+    batch->speed = new float[entities]();
+    batch->visible = new unsigned char[entities]();
+
+    batch->game_states = new game_state_t[count]();
+    batch->left_scores = new int[count]();
+    batch->right_scores = new int[count]();
+    batch->points = new int[count]();
+    batch->seconds = new float[count]();
+    batch->random = new unsigned int[count]();
+    batch->matches = new int[count]();
+
+    for (int match = 0; match < count; match++)
+    {
+        batch->game_states[match] = IDLE;
+        batch->random[match] = seed + match;
+
+        batch_setup_entity(batch, batch_left_paddle(batch, match), LEFT_PADDLE_RESOURCE);
+        batch_setup_entity(batch, batch_right_paddle(batch, match), RIGHT_PADDLE_RESOURCE);
+
+        int ball = batch_ball(batch, match);
+        batch_setup_entity(batch, ball, BALL_RESOURCE);
+        batch->dir_x[ball] = simulation_random(&batch->random[match]) % 2 == 0 ? 1 : -1;
+        batch->dir_y[ball] = simulation_random(&batch->random[match]) % 2 == 0 ? 1 : -1;
+    }
+}
+
+void batch_destroy(match_batch_t* batch)
+{
+    delete[] batch->x;
+    delete[] batch->y;
+    delete[] batch->previous_x;
+    delete[] batch->previous_y;
+    delete[] batch->pixel_x;
+    delete[] batch->pixel_y;
+    delete[] batch->w;
+    delete[] batch->h;
+    delete[] batch->dir_x;
+    delete[] batch->dir_y;
+    delete[] batch->speed;
+    delete[] batch->visible;
+
+    delete[] batch->game_states;
+    delete[] batch->left_scores;
+    delete[] batch->right_scores;
+    delete[] batch->points;
+    delete[] batch->seconds;
+    delete[] batch->random;
+    delete[] batch->matches;
+
+    *batch = {};
+}
+
+void batch_step(match_batch_t* batch, const simulation_inputs_t* inputs, float dt)
+{
+    batch_input_system(batch, inputs, 0, batch->count);
+    batch_movement_system(batch, dt, 0, batch->count);
+    batch_match_system(batch, inputs, dt, 0, batch->count);
+    batch_paddle_system(batch, 0, batch->count);
+    batch_ball_system(batch, 0, batch->count);
+}
+
+void batch_setup_entity(match_batch_t* batch, int entity, entity_resource_t resource)
+{
+    batch->w[entity] = resource.w;
+    batch->h[entity] = resource.h;
+    batch->x[entity] = resource.x;
+    batch->y[entity] = resource.y;
+    batch->previous_x[entity] = resource.x;
+    batch->previous_y[entity] = resource.y;
+    batch->speed[entity] = resource.speed;
+    batch->visible[entity] = resource.visible;
+}
+
+void batch_input_system(match_batch_t* batch, const simulation_inputs_t* inputs, int begin, int end)
+{
+    for (int match = begin; match < end; match++)
+    {
+        simulation_inputs_t input = inputs[match];
+        batch->dir_y[batch_left_paddle(batch, match)] = static_cast<float>((input.left_paddle_up ? 1 : 0) - (input.left_paddle_down ? 1 : 0));
+        batch->dir_y[batch_right_paddle(batch, match)] = static_cast<float>((input.right_paddle_up ? 1 : 0) - (input.right_paddle_down ? 1 : 0));
+    }
+}
+
+void batch_movement_system(match_batch_t* batch, float dt, int begin, int end)
+{
+    // the whole batch is one contiguous run of lanes; a slice of matches is three
+    if(begin == 0 && end == batch->count)
+    {
+        movement_kernel(batch->isa, batch, 0, batch->entity_count, dt);
+        return;
+    }
+
+    for (int role = 0; role < 3; role++)
+    {
+        movement_kernel(batch->isa, batch, role * batch->count + begin, role * batch->count + end, dt);
+    }
+}
+
+void batch_match_system(match_batch_t* batch, const simulation_inputs_t* inputs, float dt, int begin, int end)
+{
+    for (int match = begin; match < end; match++)
+    {
+        int left_paddle = batch_left_paddle(batch, match);
+        int right_paddle = batch_right_paddle(batch, match);
+        int ball = batch_ball(batch, match);
+        unsigned int* random = &batch->random[match];
+
+        switch(batch->game_states[match])
+        {
+            case IDLE:
+            {
+                if(inputs[match].enter)
+                {
+                    batch->dir_x[ball] = simulation_random(random) % 2 == 0 ? 1 : -1;
+                    batch->dir_y[ball] = simulation_random(random) % 2 == 0 ? 1 : -1;
+
+                    batch->visible[ball] = false;
+                    batch->visible[left_paddle] = true;
+                    batch->visible[right_paddle] = true;
+
+                    batch->game_states[match] = PREPARATION;
+                }
+                break;
+            }
+            case PREPARATION:
+            {
+                batch->seconds[match] += dt;
+                if(batch->seconds[match] >= 2.0)
+                {
+                    batch_setup_entity(batch, ball, BALL_RESOURCE);
+                    batch->dir_y[ball] = simulation_random(random) % 2 == 0 ? 1 : -1;
+
+                    batch->seconds[match] = 0.0;
+                    batch->points[match] = 0;
+                    batch->game_states[match] = GAMEPLAY;
+                }
+                break;
+            }
+            case GAMEPLAY:
+            {
+                float ball_x = batch->x[ball];
+
+                if(ball_x <= 0 || (ball_x + batch->w[ball] - 1) >= PIXELS_WIDTH - 1)
+                {
+                    if(ball_x <= 0)
+                    {
+                        batch->points[match] = -1;
+                        batch->left_scores[match]++;
+                    }
+                    else
+                    {
+                        batch->points[match] = 1;
+                        batch->right_scores[match]++;
+                    }
+
+                    batch->visible[ball] = false;
+                    batch->game_states[match] = POINT;
+                }
+                break;
+            }
+            case POINT:
+            {
+                batch->game_states[match] = PREPARATION;
+
+                if(batch->left_scores[match] >= WINNING_SCORE || batch->right_scores[match] >= WINNING_SCORE)
+                {
+                    batch_setup_entity(batch, ball, BALL_RESOURCE);
+                    batch_setup_entity(batch, left_paddle, LEFT_PADDLE_RESOURCE);
+                    batch_setup_entity(batch, right_paddle, RIGHT_PADDLE_RESOURCE);
+
+                    batch->left_scores[match] = batch->right_scores[match] = 0;
+                    batch->matches[match]++;
+
+                    batch->game_states[match] = IDLE;
+                }
+                break;
+            }
+        }
+    }
+}
+
+static void batch_clamp_paddles(match_batch_t* batch, int begin, int end)
+{
+    for (int paddle = begin; paddle < end; paddle++)
+    {
+        if(batch->visible[paddle] == false) continue;
+
+        float paddle_y = batch->y[paddle];
+
+        if(paddle_y <= 0)
+        {
+            paddle_y = 0;
+        }
+        else if(paddle_y + batch->h[paddle] - 1 >= PIXELS_HEIGHT - 1)
+        {
+            paddle_y = PIXELS_HEIGHT - batch->h[paddle];
+        }
+
+        batch->y[paddle] = paddle_y;
+    }
+}
+
+void batch_paddle_system(match_batch_t* batch, int begin, int end)
+{
+    // both paddle lanes are adjacent, so the whole batch is one pass over [0, 2 * count)
+    if(begin == 0 && end == batch->count)
+    {
+        batch_clamp_paddles(batch, 0, 2 * batch->count);
+        return;
+    }
+
+    batch_clamp_paddles(batch, batch_left_paddle(batch, begin), batch_left_paddle(batch, end));
+    batch_clamp_paddles(batch, batch_right_paddle(batch, begin), batch_right_paddle(batch, end));
+}
+
+void batch_ball_system(match_batch_t* batch, int begin, int end)
+{
+    ball_kernel(batch->isa, batch, begin, end);
+}
+
+static void batch_input_job(void* context, int begin, int end)
+{
+    batch_tick_t* tick = static_cast<batch_tick_t*>(context);
+    batch_input_system(tick->batch, tick->inputs, begin, end);
+}
+
+static void batch_movement_job(void* context, int begin, int end)
+{
+    batch_tick_t* tick = static_cast<batch_tick_t*>(context);
+    batch_movement_system(tick->batch, tick->dt, begin, end);
+}
+
+static void batch_match_job(void* context, int begin, int end)
+{
+    batch_tick_t* tick = static_cast<batch_tick_t*>(context);
+    batch_match_system(tick->batch, tick->inputs, tick->dt, begin, end);
+}
+
+static void batch_paddle_job(void* context, int begin, int end)
+{
+    batch_tick_t* tick = static_cast<batch_tick_t*>(context);
+    batch_paddle_system(tick->batch, begin, end);
+}
+
+static void batch_ball_job(void* context, int begin, int end)
+{
+    batch_tick_t* tick = static_cast<batch_tick_t*>(context);
+    batch_ball_system(tick->batch, begin, end);
+}
+
+void batch_schedule(scheduler_t* scheduler, batch_tick_t* tick, int grain)
+{
+    int count = tick->batch->count;
+    access_t everything = BATCH_INPUTS | BATCH_POSITIONS | BATCH_DIRECTIONS | BATCH_SHAPES | BATCH_VISIBILITY | BATCH_MATCHES;
+
+    scheduler_add_system(scheduler, {"input", batch_input_job, tick,
+        BATCH_INPUTS, BATCH_DIRECTIONS, count, grain, true});
+    scheduler_add_system(scheduler, {"movement", batch_movement_job, tick,
+        BATCH_DIRECTIONS | BATCH_SHAPES, BATCH_POSITIONS, count, grain, true});
+    // setting entities up again touches every entity column
+    scheduler_add_system(scheduler, {"match", batch_match_job, tick,
+        everything, everything & ~BATCH_INPUTS, count, grain, true});
+    scheduler_add_system(scheduler, {"paddle", batch_paddle_job, tick,
+        BATCH_POSITIONS | BATCH_SHAPES | BATCH_VISIBILITY, BATCH_POSITIONS, count, grain, true});
+    scheduler_add_system(scheduler, {"ball", batch_ball_job, tick,
+        BATCH_POSITIONS | BATCH_DIRECTIONS | BATCH_SHAPES | BATCH_VISIBILITY, BATCH_POSITIONS | BATCH_DIRECTIONS, count, grain, true});
+}
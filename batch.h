@@ -0,0 +1,81 @@
+#ifndef PONG_BATCH_H
+#define PONG_BATCH_H
+
+#include "simulation.h"
+#include "simd.h"
+#include "scheduler.h"
+
+// N independent matches stepped together with the same rules as simulation_step.
+// Entities live in structure-of-arrays lanes grouped by role, so each system walks contiguous memory:
+// [0, count) left paddles, [count, 2 * count) right paddles, [2 * count, 3 * count) balls.
+typedef struct
+{
+    int count;
+    int entity_count;
+
+    // instruction set the vectorized systems dispatch to, detected at init
+    simd_isa_t isa;
+
+    // entities
+    float* x;
+    float* y;
+    float* previous_x;
+    float* previous_y;
+    int* pixel_x;
+    int* pixel_y;
+    int* w;
+    int* h;
+    float* dir_x;
+    float* dir_y;
+    float* speed;
+    unsigned char* visible;
+
+    // matches
+    game_state_t* game_states;
+    int* left_scores;
+    int* right_scores;
+    int* points;
+    float* seconds;
+    unsigned int* random;
+    int* matches;
+} match_batch_t;
+
+inline int batch_left_paddle(const match_batch_t*, int match) { return match; }
+inline int batch_right_paddle(const match_batch_t* batch, int match) { return batch->count + match; }
+inline int batch_ball(const match_batch_t* batch, int match) { return 2 * batch->count + match; }
+
+// match i is seeded with seed + i, the same as simulation_init(state, seed + i)
+void batch_init(match_batch_t* batch, int count, unsigned int seed);
+void batch_destroy(match_batch_t* batch);
+void batch_step(match_batch_t* batch, const simulation_inputs_t* inputs, float dt);
+
+void batch_setup_entity(match_batch_t* batch, int entity, entity_resource_t resource);
+
+// Systems take a range of matches and only touch the lanes of those matches, so disjoint ranges
+// can run on different threads.
+void batch_input_system(match_batch_t* batch, const simulation_inputs_t* inputs, int begin, int end);
+void batch_movement_system(match_batch_t* batch, float dt, int begin, int end);
+void batch_match_system(match_batch_t* batch, const simulation_inputs_t* inputs, float dt, int begin, int end);
+void batch_paddle_system(match_batch_t* batch, int begin, int end);
+void batch_ball_system(match_batch_t* batch, int begin, int end);
+
+// access_t bits for the batch columns, used to declare what each scheduled system reads and writes
+const access_t BATCH_INPUTS = 1 << 0;
+const access_t BATCH_POSITIONS = 1 << 1; // x, y, previous and pixel positions
+const access_t BATCH_DIRECTIONS = 1 << 2;
+const access_t BATCH_SHAPES = 1 << 3; // w, h, speed
+const access_t BATCH_VISIBILITY = 1 << 4;
+const access_t BATCH_MATCHES = 1 << 5; // game state, scores, timers, generators
+
+// what the scheduled systems run on; update inputs and dt before each scheduler_run
+typedef struct
+{
+    match_batch_t* batch;
+    const simulation_inputs_t* inputs;
+    float dt;
+} batch_tick_t;
+
+// adds the batch_step systems in order, split into jobs of grain matches
+void batch_schedule(scheduler_t* scheduler, batch_tick_t* tick, int grain);
+
+#endif
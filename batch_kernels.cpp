@@ -0,0 +1,355 @@
+#include <string.h>
+
+#include "batch_kernels.h"
+
+void movement_kernel_scalar(match_batch_t* batch, int begin, int end, float dt)
+{
+    for (int entity = begin; entity < end; entity++)
+    {
+        batch->previous_x[entity] = batch->x[entity];
+        batch->previous_y[entity] = batch->y[entity];
+
+        batch->x[entity] += batch->dir_x[entity] * batch->speed[entity] * dt;
+        batch->y[entity] += batch->dir_y[entity] * batch->speed[entity] * dt;
+
+        batch->pixel_x[entity] = static_cast <int> (batch->x[entity]);
+        batch->pixel_y[entity] = static_cast <int> (batch->y[entity]);
+    }
+}
+
+void ball_kernel_branchy(match_batch_t* batch, int begin, int end)
+{
+    for (int match = begin; match < end; match++)
+    {
+        int ball = batch_ball(batch, match);
+        if(batch->visible[ball] == false) continue;
+
+        float ball_x = batch->x[ball];
+        float ball_y = batch->y[ball];
+        float dir_x = batch->dir_x[ball];
+        float dir_y = batch->dir_y[ball];
+        int ball_w = batch->w[ball];
+        int ball_h = batch->h[ball];
+
+        if(ball_x <= 0 || (ball_x + ball_w - 1) >= PIXELS_WIDTH - 1)
+        {
+            ball_x = ball_x <= 0 ? 0 : PIXELS_WIDTH - ball_w;
+            dir_x *= -1;
+        }
+        if(ball_y <= 0 || (ball_y + ball_h - 1) >= PIXELS_HEIGHT - 1)
+        {
+            ball_y = ball_y <= 0 ? 0 : PIXELS_HEIGHT - ball_h;
+            dir_y *= -1;
+        }
+
+        int paddles[2] = {batch_left_paddle(batch, match), batch_right_paddle(batch, match)};
+        for (int i = 0; i < 2; i++)
+        {
+            int paddle = paddles[i];
+            if(batch->visible[paddle] == false) continue;
+
+            float paddle_x = batch->x[paddle];
+            float paddle_y = batch->y[paddle];
+
+            if(ball_x < paddle_x + batch->w[paddle] && ball_x + ball_w > paddle_x)
+            {
+                if(ball_y < paddle_y + batch->h[paddle] && ball_y + ball_h > paddle_y)
+                {
+                    if(dir_x == -1)
+                    {
+                        ball_x = paddle_x + batch->w[paddle];
+                    }
+                    else if(dir_x == 1)
+                    {
+                        ball_x = paddle_x - ball_w;
+                    }
+
+                    dir_x *= -1;
+                }
+            }
+        }
+
+        batch->x[ball] = ball_x;
+        batch->y[ball] = ball_y;
+        batch->dir_x[ball] = dir_x;
+        batch->dir_y[ball] = dir_y;
+    }
+}
+
+#if defined(PONG_SIMD_X86)
+
+void movement_kernel_sse(match_batch_t* batch, int begin, int end, float dt)
+{
+    const __m128 delta = _mm_set1_ps(dt);
+
+    int entity = begin;
+    for (; entity + 4 <= end; entity += 4)
+    {
+        __m128 x = _mm_loadu_ps(batch->x + entity);
+        __m128 y = _mm_loadu_ps(batch->y + entity);
+        __m128 speed = _mm_loadu_ps(batch->speed + entity);
+
+        _mm_storeu_ps(batch->previous_x + entity, x);
+        _mm_storeu_ps(batch->previous_y + entity, y);
+
+        // same evaluation order as the scalar path: (dir * speed) * dt, then the add
+        x = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(batch->dir_x + entity), speed), delta));
+        y = _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(batch->dir_y + entity), speed), delta));
+
+        _mm_storeu_ps(batch->x + entity, x);
+        _mm_storeu_ps(batch->y + entity, y);
+
+        // truncating conversion, matching static_cast<int>
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch->pixel_x + entity), _mm_cvttps_epi32(x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch->pixel_y + entity), _mm_cvttps_epi32(y));
+    }
+
+    movement_kernel_scalar(batch, entity, end, dt);
+}
+
+static inline __m128 sse_select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+}
+
+static inline __m128 sse_load_visible(const unsigned char* visible)
+{
+    int bytes;
+    memcpy(&bytes, visible, sizeof(bytes));
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(lanes, zero));
+}
+
+// Same rules as ball_kernel_branchy, four matches at a time: every test becomes a lane mask and every
+// branch a select, so the cost no longer depends on where the balls are.
+void ball_kernel_sse(match_batch_t* batch, int begin, int end)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minus_one = _mm_set1_ps(-1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 last_column = _mm_set1_ps(PIXELS_WIDTH - 1);
+    const __m128 last_row = _mm_set1_ps(PIXELS_HEIGHT - 1);
+    const __m128i width = _mm_set1_epi32(PIXELS_WIDTH);
+    const __m128i height = _mm_set1_epi32(PIXELS_HEIGHT);
+
+    int match = begin;
+    for (; match + 4 <= end; match += 4)
+    {
+        int ball = batch_ball(batch, match);
+
+        __m128 ball_x = _mm_loadu_ps(batch->x + ball);
+        __m128 ball_y = _mm_loadu_ps(batch->y + ball);
+        __m128 dir_x = _mm_loadu_ps(batch->dir_x + ball);
+        __m128 dir_y = _mm_loadu_ps(batch->dir_y + ball);
+        __m128i ball_w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch->w + ball));
+        __m128i ball_h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch->h + ball));
+        __m128 ball_wf = _mm_cvtepi32_ps(ball_w);
+        __m128 ball_hf = _mm_cvtepi32_ps(ball_h);
+        __m128 visible = sse_load_visible(batch->visible + ball);
+
+        __m128 x = ball_x;
+        __m128 y = ball_y;
+        __m128 dx = dir_x;
+        __m128 dy = dir_y;
+
+        // walls
+        __m128 left = _mm_cmple_ps(x, zero);
+        __m128 wall = _mm_or_ps(left, _mm_cmpge_ps(_mm_sub_ps(_mm_add_ps(x, ball_wf), one), last_column));
+        x = sse_select(wall, x, sse_select(left, _mm_cvtepi32_ps(_mm_sub_epi32(width, ball_w)), zero));
+        dx = sse_select(wall, dx, _mm_xor_ps(dx, sign));
+
+        __m128 bottom = _mm_cmple_ps(y, zero);
+        wall = _mm_or_ps(bottom, _mm_cmpge_ps(_mm_sub_ps(_mm_add_ps(y, ball_hf), one), last_row));
+        y = sse_select(wall, y, sse_select(bottom, _mm_cvtepi32_ps(_mm_sub_epi32(height, ball_h)), zero));
+        dy = sse_select(wall, dy, _mm_xor_ps(dy, sign));
+
+        // paddles, in order, each seeing the result of the previous one
+        int paddles[2] = {batch_left_paddle(batch, match), batch_right_paddle(batch, match)};
+        for (int i = 0; i < 2; i++)
+        {
+            int paddle = paddles[i];
+            __m128 paddle_x = _mm_loadu_ps(batch->x + paddle);
+            __m128 paddle_y = _mm_loadu_ps(batch->y + paddle);
+            __m128 paddle_w = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(batch->w + paddle)));
+            __m128 paddle_h = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(batch->h + paddle)));
+
+            __m128 hit = sse_load_visible(batch->visible + paddle);
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(x, _mm_add_ps(paddle_x, paddle_w)));
+            hit = _mm_and_ps(hit, _mm_cmpgt_ps(_mm_add_ps(x, ball_wf), paddle_x));
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(y, _mm_add_ps(paddle_y, paddle_h)));
+            hit = _mm_and_ps(hit, _mm_cmpgt_ps(_mm_add_ps(y, ball_hf), paddle_y));
+
+            __m128 pushed = x;
+            pushed = sse_select(_mm_cmpeq_ps(dx, one), pushed, _mm_sub_ps(paddle_x, ball_wf));
+            pushed = sse_select(_mm_cmpeq_ps(dx, minus_one), pushed, _mm_add_ps(paddle_x, paddle_w));
+
+            x = sse_select(hit, x, pushed);
+            dx = sse_select(hit, dx, _mm_xor_ps(dx, sign));
+        }
+
+        // hidden balls are left untouched
+        _mm_storeu_ps(batch->x + ball, sse_select(visible, ball_x, x));
+        _mm_storeu_ps(batch->y + ball, sse_select(visible, ball_y, y));
+        _mm_storeu_ps(batch->dir_x + ball, sse_select(visible, dir_x, dx));
+        _mm_storeu_ps(batch->dir_y + ball, sse_select(visible, dir_y, dy));
+    }
+
+    ball_kernel_branchy(batch, match, end);
+}
+
+PONG_TARGET_AVX2
+void movement_kernel_avx2(match_batch_t* batch, int begin, int end, float dt)
+{
+    const __m256 delta = _mm256_set1_ps(dt);
+
+    int entity = begin;
+    for (; entity + 8 <= end; entity += 8)
+    {
+        __m256 x = _mm256_loadu_ps(batch->x + entity);
+        __m256 y = _mm256_loadu_ps(batch->y + entity);
+        __m256 speed = _mm256_loadu_ps(batch->speed + entity);
+
+        _mm256_storeu_ps(batch->previous_x + entity, x);
+        _mm256_storeu_ps(batch->previous_y + entity, y);
+
+        // kept as separate multiply and add: a fused multiply-add would round differently
+        x = _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(batch->dir_x + entity), speed), delta));
+        y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(batch->dir_y + entity), speed), delta));
+
+        _mm256_storeu_ps(batch->x + entity, x);
+        _mm256_storeu_ps(batch->y + entity, y);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch->pixel_x + entity), _mm256_cvttps_epi32(x));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch->pixel_y + entity), _mm256_cvttps_epi32(y));
+    }
+
+    movement_kernel_scalar(batch, entity, end, dt);
+}
+
+PONG_TARGET_AVX2
+static inline __m256 avx2_load_visible(const unsigned char* visible)
+{
+    __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(visible)));
+    return _mm256_castsi256_ps(_mm256_cmpgt_epi32(lanes, _mm256_setzero_si256()));
+}
+
+PONG_TARGET_AVX2
+void ball_kernel_avx2(match_batch_t* batch, int begin, int end)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minus_one = _mm256_set1_ps(-1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 last_column = _mm256_set1_ps(PIXELS_WIDTH - 1);
+    const __m256 last_row = _mm256_set1_ps(PIXELS_HEIGHT - 1);
+    const __m256i width = _mm256_set1_epi32(PIXELS_WIDTH);
+    const __m256i height = _mm256_set1_epi32(PIXELS_HEIGHT);
+
+    int match = begin;
+    for (; match + 8 <= end; match += 8)
+    {
+        int ball = batch_ball(batch, match);
+
+        __m256 ball_x = _mm256_loadu_ps(batch->x + ball);
+        __m256 ball_y = _mm256_loadu_ps(batch->y + ball);
+        __m256 dir_x = _mm256_loadu_ps(batch->dir_x + ball);
+        __m256 dir_y = _mm256_loadu_ps(batch->dir_y + ball);
+        __m256i ball_w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch->w + ball));
+        __m256i ball_h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch->h + ball));
+        __m256 ball_wf = _mm256_cvtepi32_ps(ball_w);
+        __m256 ball_hf = _mm256_cvtepi32_ps(ball_h);
+        __m256 visible = avx2_load_visible(batch->visible + ball);
+
+        __m256 x = ball_x;
+        __m256 y = ball_y;
+        __m256 dx = dir_x;
+        __m256 dy = dir_y;
+
+        __m256 left = _mm256_cmp_ps(x, zero, _CMP_LE_OQ);
+        __m256 wall = _mm256_or_ps(left, _mm256_cmp_ps(_mm256_sub_ps(_mm256_add_ps(x, ball_wf), one), last_column, _CMP_GE_OQ));
+        x = _mm256_blendv_ps(x, _mm256_blendv_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(width, ball_w)), zero, left), wall);
+        dx = _mm256_blendv_ps(dx, _mm256_xor_ps(dx, sign), wall);
+
+        __m256 bottom = _mm256_cmp_ps(y, zero, _CMP_LE_OQ);
+        wall = _mm256_or_ps(bottom, _mm256_cmp_ps(_mm256_sub_ps(_mm256_add_ps(y, ball_hf), one), last_row, _CMP_GE_OQ));
+        y = _mm256_blendv_ps(y, _mm256_blendv_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(height, ball_h)), zero, bottom), wall);
+        dy = _mm256_blendv_ps(dy, _mm256_xor_ps(dy, sign), wall);
+
+        int paddles[2] = {batch_left_paddle(batch, match), batch_right_paddle(batch, match)};
+        for (int i = 0; i < 2; i++)
+        {
+            int paddle = paddles[i];
+            __m256 paddle_x = _mm256_loadu_ps(batch->x + paddle);
+            __m256 paddle_y = _mm256_loadu_ps(batch->y + paddle);
+            __m256 paddle_w = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch->w + paddle)));
+            __m256 paddle_h = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch->h + paddle)));
+
+            __m256 hit = avx2_load_visible(batch->visible + paddle);
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(x, _mm256_add_ps(paddle_x, paddle_w), _CMP_LT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(x, ball_wf), paddle_x, _CMP_GT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(y, _mm256_add_ps(paddle_y, paddle_h), _CMP_LT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(y, ball_hf), paddle_y, _CMP_GT_OQ));
+
+            __m256 pushed = x;
+            pushed = _mm256_blendv_ps(pushed, _mm256_sub_ps(paddle_x, ball_wf), _mm256_cmp_ps(dx, one, _CMP_EQ_OQ));
+            pushed = _mm256_blendv_ps(pushed, _mm256_add_ps(paddle_x, paddle_w), _mm256_cmp_ps(dx, minus_one, _CMP_EQ_OQ));
+
+            x = _mm256_blendv_ps(x, pushed, hit);
+            dx = _mm256_blendv_ps(dx, _mm256_xor_ps(dx, sign), hit);
+        }
+
+        _mm256_storeu_ps(batch->x + ball, _mm256_blendv_ps(ball_x, x, visible));
+        _mm256_storeu_ps(batch->y + ball, _mm256_blendv_ps(ball_y, y, visible));
+        _mm256_storeu_ps(batch->dir_x + ball, _mm256_blendv_ps(dir_x, dx, visible));
+        _mm256_storeu_ps(batch->dir_y + ball, _mm256_blendv_ps(dir_y, dy, visible));
+    }
+
+    ball_kernel_branchy(batch, match, end);
+}
+
+#else
+
+void movement_kernel_sse(match_batch_t* batch, int begin, int end, float dt)
+{
+    movement_kernel_scalar(batch, begin, end, dt);
+}
+
+void movement_kernel_avx2(match_batch_t* batch, int begin, int end, float dt)
+{
+    movement_kernel_scalar(batch, begin, end, dt);
+}
+
+void ball_kernel_sse(match_batch_t* batch, int begin, int end)
+{
+    ball_kernel_branchy(batch, begin, end);
+}
+
+void ball_kernel_avx2(match_batch_t* batch, int begin, int end)
+{
+    ball_kernel_branchy(batch, begin, end);
+}
+
+#endif
+
+void movement_kernel(simd_isa_t isa, match_batch_t* batch, int begin, int end, float dt)
+{
+    switch(isa)
+    {
+        case SIMD_AVX2: movement_kernel_avx2(batch, begin, end, dt); break;
+        case SIMD_SSE: movement_kernel_sse(batch, begin, end, dt); break;
+        default: movement_kernel_scalar(batch, begin, end, dt); break;
+    }
+}
+
+void ball_kernel(simd_isa_t isa, match_batch_t* batch, int begin, int end)
+{
+    switch(isa)
+    {
+        case SIMD_AVX2: ball_kernel_avx2(batch, begin, end); break;
+        case SIMD_SSE: ball_kernel_sse(batch, begin, end); break;
+        default: ball_kernel_branchy(batch, begin, end); break;
+    }
+}
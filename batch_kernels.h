@@ -0,0 +1,21 @@
+#ifndef PONG_BATCH_KERNELS_H
+#define PONG_BATCH_KERNELS_H
+
+#include "batch.h"
+
+// Vectorized inner loops for the batch systems. Every path must produce bit-identical results
+// to the scalar one; pong_headless kernels checks that and times them side by side.
+void movement_kernel_scalar(match_batch_t* batch, int begin, int end, float dt);
+void movement_kernel_sse(match_batch_t* batch, int begin, int end, float dt);
+void movement_kernel_avx2(match_batch_t* batch, int begin, int end, float dt);
+
+void movement_kernel(simd_isa_t isa, match_batch_t* batch, int begin, int end, float dt);
+
+// ranges are in matches; the branchy version is the reference the branchless ones are checked against
+void ball_kernel_branchy(match_batch_t* batch, int begin, int end);
+void ball_kernel_sse(match_batch_t* batch, int begin, int end);
+void ball_kernel_avx2(match_batch_t* batch, int begin, int end);
+
+void ball_kernel(simd_isa_t isa, match_batch_t* batch, int begin, int end);
+
+#endif
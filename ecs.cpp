@@ -0,0 +1,196 @@
+#include <string.h>
+
+#include "ecs.h"
+
+static int align_up(int value, int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static int find_archetype(entity_manager_t* entity_manager, signature_t signature)
+{
+    for (int i = 0; i < static_cast<int>(entity_manager->archetypes.size()); i++)
+    {
+        if(entity_manager->archetypes[i].signature == signature) return i;
+    }
+
+    archetype_t archetype = {};
+    archetype.signature = signature;
+
+    // leave room for each column to be padded up to its alignment
+    int row_size = sizeof(entity_t);
+    for (int component = 0; component < COMPONENT_TYPES; component++)
+    {
+        if(signature_has(signature, component)) row_size += COMPONENT_SIZES[component];
+    }
+    archetype.capacity = (CHUNK_SIZE - (COMPONENT_TYPES + 1) * CHUNK_COLUMN_ALIGNMENT) / row_size;
+
+    int offset = 0;
+    for (int component = 0; component < COMPONENT_TYPES; component++)
+    {
+        archetype.offsets[component] = -1;
+        if(signature_has(signature, component) == false) continue;
+
+        archetype.offsets[component] = offset;
+        offset = align_up(offset + archetype.capacity * COMPONENT_SIZES[component], CHUNK_COLUMN_ALIGNMENT);
+    }
+    archetype.entities_offset = offset;
+
+    int index = static_cast<int>(entity_manager->archetypes.size());
+    entity_manager->archetypes.push_back(archetype);
+
+    for (int i = 0; i < static_cast<int>(entity_manager->queries.size()); i++)
+    {
+        query_t* query = &entity_manager->queries[i];
+        if((signature & query->signature) == query->signature) query->archetypes.push_back(index);
+    }
+
+    return index;
+}
+
+static entity_t* archetype_owner(archetype_t* archetype, int row)
+{
+    return archetype_entities(archetype, row / archetype->capacity) + row % archetype->capacity;
+}
+
+static int archetype_push_row(archetype_t* archetype, entity_t entity)
+{
+    int row = archetype->count++;
+    if(row / archetype->capacity >= static_cast<int>(archetype->chunks.size()))
+    {
+        archetype->chunks.emplace_back();
+        archetype->chunks.back().memory.resize(CHUNK_SIZE);
+    }
+
+    for (int component = 0; component < COMPONENT_TYPES; component++)
+    {
+        if(signature_has(archetype->signature, component) == false) continue;
+        memset(archetype_element(archetype, row, component), 0, COMPONENT_SIZES[component]);
+    }
+    *archetype_owner(archetype, row) = entity;
+
+    return row;
+}
+
+// moves the archetype's last row into the hole so rows stay packed
+static void archetype_remove_row(entity_manager_t* entity_manager, int archetype_index, int row)
+{
+    archetype_t* archetype = &entity_manager->archetypes[archetype_index];
+    int last = archetype->count - 1;
+
+    if(row != last)
+    {
+        for (int component = 0; component < COMPONENT_TYPES; component++)
+        {
+            if(signature_has(archetype->signature, component) == false) continue;
+            memcpy(archetype_element(archetype, row, component), archetype_element(archetype, last, component), COMPONENT_SIZES[component]);
+        }
+
+        entity_t moved = *archetype_owner(archetype, last);
+        *archetype_owner(archetype, row) = moved;
+        entity_manager->locations[entity_index(moved)].row = row;
+    }
+
+    archetype->count--;
+}
+
+static void move_entity(entity_manager_t* entity_manager, entity_t entity, signature_t signature)
+{
+    int index = entity_index(entity);
+    entity_location_t from = entity_manager->locations[index];
+
+    int to = find_archetype(entity_manager, signature);
+    if(to == from.archetype) return;
+
+    archetype_t* source = &entity_manager->archetypes[from.archetype];
+    archetype_t* destination = &entity_manager->archetypes[to];
+    int row = archetype_push_row(destination, entity);
+
+    for (int component = 0; component < COMPONENT_TYPES; component++)
+    {
+        if(signature_has(source->signature, component) == false || signature_has(signature, component) == false) continue;
+        memcpy(archetype_element(destination, row, component), archetype_element(source, from.row, component), COMPONENT_SIZES[component]);
+    }
+
+    archetype_remove_row(entity_manager, from.archetype, from.row);
+    entity_manager->locations[index] = {to, row};
+}
+
+entity_t create_entity(entity_manager_t* entity_manager, signature_t signature)
+{
+    int index;
+    if(entity_manager->free_indices.empty() == false)
+    {
+        index = entity_manager->free_indices.back();
+        entity_manager->free_indices.pop_back();
+    }
+    else
+    {
+        if(static_cast<int>(entity_manager->generations.size()) == ENTITY_MAX_SLOTS) return NULL_ENTITY;
+
+        index = static_cast<int>(entity_manager->generations.size());
+        entity_manager->generations.push_back(0);
+        entity_manager->locations.push_back({});
+    }
+
+    entity_t entity = (entity_manager->generations[index] << ENTITY_INDEX_BITS) | static_cast<unsigned int>(index);
+
+    int archetype = find_archetype(entity_manager, signature);
+    int row = archetype_push_row(&entity_manager->archetypes[archetype], entity);
+    entity_manager->locations[index] = {archetype, row};
+    entity_manager->alive++;
+
+    return entity;
+}
+
+void destroy_entity(entity_manager_t* entity_manager, entity_t entity)
+{
+    if(entity_alive(entity_manager, entity) == false) return;
+
+    int index = entity_index(entity);
+    entity_location_t location = entity_manager->locations[index];
+    archetype_remove_row(entity_manager, location.archetype, location.row);
+
+    entity_manager->alive--;
+
+    // the last generation is left on the slot so no handle can match it again
+    entity_manager->generations[index]++;
+    if(entity_manager->generations[index] == ENTITY_GENERATION_MAX) entity_manager->retired++;
+    else entity_manager->free_indices.push_back(index);
+}
+
+void add_components(entity_manager_t* entity_manager, entity_t entity, signature_t signature)
+{
+    if(entity_alive(entity_manager, entity) == false) return;
+
+    entity_location_t location = entity_manager->locations[entity_index(entity)];
+    signature_t current = entity_manager->archetypes[location.archetype].signature;
+    move_entity(entity_manager, entity, current | signature);
+}
+
+void remove_components(entity_manager_t* entity_manager, entity_t entity, signature_t signature)
+{
+    if(entity_alive(entity_manager, entity) == false) return;
+
+    entity_location_t location = entity_manager->locations[entity_index(entity)];
+    signature_t current = entity_manager->archetypes[location.archetype].signature;
+    move_entity(entity_manager, entity, current & ~signature);
+}
+
+const query_t* entity_query(entity_manager_t* entity_manager, signature_t signature)
+{
+    for (int i = 0; i < static_cast<int>(entity_manager->queries.size()); i++)
+    {
+        if(entity_manager->queries[i].signature == signature) return &entity_manager->queries[i];
+    }
+
+    query_t query = {};
+    query.signature = signature;
+    for (int i = 0; i < static_cast<int>(entity_manager->archetypes.size()); i++)
+    {
+        if((entity_manager->archetypes[i].signature & signature) == signature) query.archetypes.push_back(i);
+    }
+
+    entity_manager->queries.push_back(query);
+    return &entity_manager->queries.back();
+}
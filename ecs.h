@@ -0,0 +1,240 @@
+#ifndef PONG_ECS_H
+#define PONG_ECS_H
+
+#include <vector>
+#include <deque>
+
+// Column index of each component; signatures use one bit per index (see component_bit)
+typedef enum {
+    EXTENSION,
+    POSITION,
+    MOVEMENT,
+    RENDERER
+} component_uid_t;
+
+const int COMPONENT_TYPES = 4;
+
+typedef unsigned int signature_t;
+
+typedef struct
+{
+    int w, h;
+} extension_t;
+
+typedef struct
+{
+    float x, y;
+    float previous_x, previous_y;
+    int pixel_x, pixel_y;
+} position_t;
+
+typedef struct
+{
+    float dir_x, dir_y;
+    float speed;
+} movement_t;
+
+typedef struct
+{
+    bool visible;
+} renderer_t;
+
+// Typed component registry: every component type maps to its column at compile time
+template <typename T> struct component_traits;
+template <> struct component_traits<extension_t> { static constexpr component_uid_t uid = EXTENSION; };
+template <> struct component_traits<position_t> { static constexpr component_uid_t uid = POSITION; };
+template <> struct component_traits<movement_t> { static constexpr component_uid_t uid = MOVEMENT; };
+template <> struct component_traits<renderer_t> { static constexpr component_uid_t uid = RENDERER; };
+
+constexpr signature_t component_bit(component_uid_t component) { return 1u << component; }
+
+template <typename... T>
+constexpr signature_t component_signature()
+{
+    return (0u | ... | component_bit(component_traits<T>::uid));
+}
+
+static_assert(component_signature<extension_t, position_t, movement_t>() != component_signature<renderer_t>(),
+    "component signatures must not alias");
+
+// Entity handle: slot index in the low bits, generation of that slot in the high bits. Destroying an
+// entity bumps its slot's generation, so handles kept from before fail the lookup instead of aliasing
+// whatever reuses the slot. Generations never wrap: a slot whose generation would reach
+// ENTITY_GENERATION_MAX is retired for good, and that generation only ever appears in NULL_ENTITY.
+typedef unsigned int entity_t;
+
+const int ENTITY_INDEX_BITS = 20;
+const int ENTITY_MAX_SLOTS = 1 << ENTITY_INDEX_BITS;
+const unsigned int ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+const unsigned int ENTITY_GENERATION_MAX = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+const entity_t NULL_ENTITY = 0xFFFFFFFFu;
+
+inline int entity_index(entity_t entity) { return static_cast<int>(entity & ENTITY_INDEX_MASK); }
+inline unsigned int entity_generation(entity_t entity) { return entity >> ENTITY_INDEX_BITS; }
+
+const int COMPONENT_SIZES[COMPONENT_TYPES] = {
+    sizeof(extension_t),
+    sizeof(position_t),
+    sizeof(movement_t),
+    sizeof(renderer_t),
+};
+
+const int CHUNK_SIZE = 16 * 1024;
+const int CHUNK_COLUMN_ALIGNMENT = 16;
+
+typedef struct
+{
+    std::vector<unsigned char> memory;
+} chunk_t;
+
+// All entities with the same component signature. Rows are packed from the first chunk on, and every
+// chunk lays its components out as columns at the same offsets, followed by the owning handles.
+// Chunks are kept when they empty so despawning and respawning does not go back to the heap.
+typedef struct
+{
+    signature_t signature;
+    int capacity;
+    int offsets[COMPONENT_TYPES];
+    int entities_offset;
+    int count;
+    std::vector<chunk_t> chunks;
+} archetype_t;
+
+typedef struct
+{
+    int archetype;
+    int row;
+} entity_location_t;
+
+// Archetypes holding at least the requested components. Kept up to date as archetypes are created,
+// so systems never test masks per entity.
+typedef struct
+{
+    signature_t signature;
+    std::vector<int> archetypes;
+} query_t;
+
+// Entities grouped by component signature into archetypes; freed slots are recycled from
+// free_indices, so steady spawn/despawn reuses capacity that is already there.
+typedef struct
+{
+    std::vector<unsigned int> generations;
+    std::vector<int> free_indices;
+    std::vector<entity_location_t> locations;
+
+    std::vector<archetype_t> archetypes;
+    std::deque<query_t> queries; // never moves a query, so one can be created while another is iterated
+
+    int alive;
+    int retired; // slots whose generations ran out
+} entity_manager_t;
+
+// NULL_ENTITY, with nothing created, once all ENTITY_MAX_SLOTS slots are alive or retired
+entity_t create_entity(entity_manager_t* entity_manager, signature_t signature);
+void destroy_entity(entity_manager_t* entity_manager, entity_t entity);
+void add_components(entity_manager_t* entity_manager, entity_t entity, signature_t signature);
+void remove_components(entity_manager_t* entity_manager, entity_t entity, signature_t signature);
+
+inline bool signature_has(signature_t signature, int component)
+{
+    return (signature & component_bit(static_cast<component_uid_t>(component))) != 0;
+}
+
+inline unsigned char* archetype_element(archetype_t* archetype, int row, int component)
+{
+    int chunk = row / archetype->capacity;
+    int slot = row % archetype->capacity;
+    return archetype->chunks[chunk].memory.data() + archetype->offsets[component] + slot * COMPONENT_SIZES[component];
+}
+
+inline bool entity_alive(const entity_manager_t* entity_manager, entity_t entity)
+{
+    int index = entity_index(entity);
+    return entity != NULL_ENTITY &&
+        index < static_cast<int>(entity_manager->generations.size()) &&
+        entity_manager->generations[index] == entity_generation(entity);
+}
+
+// nullptr when the entity is stale or does not have the component; pointers are only valid until the
+// next create, destroy, add or remove
+inline void* entity_component(entity_manager_t* entity_manager, entity_t entity, component_uid_t component)
+{
+    if(entity_alive(entity_manager, entity) == false) return nullptr;
+
+    entity_location_t location = entity_manager->locations[entity_index(entity)];
+    archetype_t* archetype = &entity_manager->archetypes[location.archetype];
+    if(signature_has(archetype->signature, component) == false) return nullptr;
+
+    return archetype_element(archetype, location.row, component);
+}
+
+template <typename T>
+T* get_component(entity_manager_t* entity_manager, entity_t entity)
+{
+    return static_cast<T*>(entity_component(entity_manager, entity, component_traits<T>::uid));
+}
+
+inline extension_t* get_extension(entity_manager_t* entity_manager, entity_t entity) { return get_component<extension_t>(entity_manager, entity); }
+inline position_t* get_position(entity_manager_t* entity_manager, entity_t entity) { return get_component<position_t>(entity_manager, entity); }
+inline movement_t* get_movement(entity_manager_t* entity_manager, entity_t entity) { return get_component<movement_t>(entity_manager, entity); }
+inline renderer_t* get_renderer(entity_manager_t* entity_manager, entity_t entity) { return get_component<renderer_t>(entity_manager, entity); }
+
+// the query is created on first use and stays at the same address for the manager's lifetime
+const query_t* entity_query(entity_manager_t* entity_manager, signature_t signature);
+
+inline int archetype_chunk_rows(const archetype_t* archetype, int chunk)
+{
+    int rows = archetype->count - chunk * archetype->capacity;
+    return rows < archetype->capacity ? rows : archetype->capacity;
+}
+
+inline int archetype_chunk_count(const archetype_t* archetype)
+{
+    return (archetype->count + archetype->capacity - 1) / archetype->capacity;
+}
+
+template <typename T>
+T* archetype_column(archetype_t* archetype, int chunk)
+{
+    return reinterpret_cast<T*>(archetype->chunks[chunk].memory.data() + archetype->offsets[component_traits<T>::uid]);
+}
+
+inline entity_t* archetype_entities(archetype_t* archetype, int chunk)
+{
+    return reinterpret_cast<entity_t*>(archetype->chunks[chunk].memory.data() + archetype->entities_offset);
+}
+
+// Runs system(rows, T* columns...) over every chunk holding all of T. The required signature is
+// a compile-time constant of the system, so only the archetype list is looked up at runtime.
+template <typename... T, typename System>
+void entity_each(entity_manager_t* entity_manager, System system)
+{
+    constexpr signature_t signature = component_signature<T...>();
+    const query_t* query = entity_query(entity_manager, signature);
+    for (int i = 0; i < static_cast<int>(query->archetypes.size()); i++)
+    {
+        archetype_t* archetype = &entity_manager->archetypes[query->archetypes[i]];
+        for (int chunk = 0; chunk < archetype_chunk_count(archetype); chunk++)
+        {
+            system(archetype_chunk_rows(archetype, chunk), archetype_column<T>(archetype, chunk)...);
+        }
+    }
+}
+
+// entity_each that also passes the handles owning each row: system(rows, entities, T* columns...)
+template <typename... T, typename System>
+void entity_each_handle(entity_manager_t* entity_manager, System system)
+{
+    constexpr signature_t signature = component_signature<T...>();
+    const query_t* query = entity_query(entity_manager, signature);
+    for (int i = 0; i < static_cast<int>(query->archetypes.size()); i++)
+    {
+        archetype_t* archetype = &entity_manager->archetypes[query->archetypes[i]];
+        for (int chunk = 0; chunk < archetype_chunk_count(archetype); chunk++)
+        {
+            system(archetype_chunk_rows(archetype, chunk), archetype_entities(archetype, chunk), archetype_column<T>(archetype, chunk)...);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,581 @@
+#include <string.h>
+
+#include "framebuffer.h"
+
+void framebuffer_init(framebuffer_t* framebuffer, int width, int height)
+{
+    *framebuffer = {};
+    framebuffer->width = width;
+    framebuffer->height = height;
+    framebuffer->stride = (width + 63) / 64;
+    framebuffer->bits = new uint64_t[framebuffer->stride * height]();
+    framebuffer->dirty.reserve(FRAMEBUFFER_DIRTY_RESERVE);
+}
+
+bool framebuffer_init_arena(framebuffer_t* framebuffer, int width, int height, arena_t* arena)
+{
+    *framebuffer = {};
+    int stride = (width + 63) / 64;
+    uint64_t* bits = arena_array<uint64_t>(arena, stride * height);
+    if(bits == NULL) return false;
+
+    memset(bits, 0, stride * height * sizeof(uint64_t));
+    framebuffer->width = width;
+    framebuffer->height = height;
+    framebuffer->stride = stride;
+    framebuffer->bits = bits;
+    framebuffer->arena = arena;
+    framebuffer->dirty.reserve(FRAMEBUFFER_DIRTY_RESERVE);
+    return true;
+}
+
+void framebuffer_destroy(framebuffer_t* framebuffer)
+{
+    if(framebuffer->arena == NULL)
+    {
+        delete[] framebuffer->background;
+        delete[] framebuffer->bits;
+    }
+    *framebuffer = {};
+}
+
+// bits [begin, end) of word, with begin < end <= 64
+static inline uint64_t word_mask(int begin, int end)
+{
+    uint64_t high = end == 64 ? ~0ull : (1ull << end) - 1;
+    return high & ~((1ull << begin) - 1);
+}
+
+static void row_span(uint64_t* row, int x0, int x1, bool on)
+{
+    for (int word = x0 / 64; word <= (x1 - 1) / 64; word++)
+    {
+        int begin = x0 > word * 64 ? x0 - word * 64 : 0;
+        int end = x1 < word * 64 + 64 ? x1 - word * 64 : 64;
+        uint64_t mask = word_mask(begin, end);
+        row[word] = on ? row[word] | mask : row[word] & ~mask;
+    }
+}
+
+static void framebuffer_span(framebuffer_t* framebuffer, int y, int x0, int x1, bool on)
+{
+    row_span(framebuffer->bits + y * framebuffer->stride, x0, x1, on);
+}
+
+// like a span switched off, but back to the background's pixels
+static void framebuffer_restore_span(framebuffer_t* framebuffer, int y, int x0, int x1)
+{
+    if(framebuffer->background == NULL)
+    {
+        framebuffer_span(framebuffer, y, x0, x1, false);
+        return;
+    }
+
+    uint64_t* row = framebuffer->bits + y * framebuffer->stride;
+    const uint64_t* background = framebuffer->background + y * framebuffer->stride;
+    for (int word = x0 / 64; word <= (x1 - 1) / 64; word++)
+    {
+        int begin = x0 > word * 64 ? x0 - word * 64 : 0;
+        int end = x1 < word * 64 + 64 ? x1 - word * 64 : 64;
+        uint64_t mask = word_mask(begin, end);
+        row[word] = (row[word] & ~mask) | (background[word] & mask);
+    }
+}
+
+static void framebuffer_clear_naive(framebuffer_t* framebuffer)
+{
+    for (int x = 0; x < framebuffer->width; x++)
+    {
+        for (int y = 0; y < framebuffer->height; y++)
+        {
+            int word = y * framebuffer->stride + x / 64;
+            uint64_t bit = 1ull << (x % 64);
+            bool on = framebuffer->background != NULL && (framebuffer->background[word] & bit) != 0;
+            framebuffer->bits[word] = on ? framebuffer->bits[word] | bit : framebuffer->bits[word] & ~bit;
+        }
+    }
+}
+
+// count bytes of the background, or zeros without one
+static void framebuffer_reset_bytes(const framebuffer_t* framebuffer, size_t offset, size_t count)
+{
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(framebuffer->bits) + offset;
+    if(framebuffer->background == NULL) memset(bytes, 0, count);
+    else memcpy(bytes, reinterpret_cast<const unsigned char*>(framebuffer->background) + offset, count);
+}
+
+static void framebuffer_clear_stream(framebuffer_t* framebuffer)
+{
+    size_t size = framebuffer_bytes(framebuffer);
+
+#ifdef PONG_SIMD_X86
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(framebuffer->bits);
+    const unsigned char* background = reinterpret_cast<const unsigned char*>(framebuffer->background);
+
+    // plain stores up to the first 16 byte boundary and after the last one
+    size_t head = (16 - reinterpret_cast<uintptr_t>(bytes) % 16) % 16;
+    if(head > size) head = size;
+    framebuffer_reset_bytes(framebuffer, 0, head);
+
+    size_t body = (size - head) / 16 * 16;
+    __m128i zero = _mm_setzero_si128();
+    for (size_t i = head; i < head + body; i += 16)
+    {
+        __m128i value = background == NULL ? zero : _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + i));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(bytes + i), value);
+    }
+    _mm_sfence();
+
+    framebuffer_reset_bytes(framebuffer, head + body, size - head - body);
+#else
+    framebuffer_reset_bytes(framebuffer, 0, size);
+#endif
+}
+
+static void framebuffer_clear_dirty(framebuffer_t* framebuffer)
+{
+    for (int i = 0; i < static_cast<int>(framebuffer->dirty.size()); i++)
+    {
+        rect_t rect = framebuffer->dirty[i];
+        for (int y = rect.y; y < rect.y + rect.h; y++)
+        {
+            framebuffer_restore_span(framebuffer, y, rect.x, rect.x + rect.w);
+        }
+        framebuffer->touched += rect.w * rect.h;
+    }
+}
+
+bool framebuffer_set_background(framebuffer_t* framebuffer, const framebuffer_t* layer)
+{
+    int words = framebuffer->stride * framebuffer->height;
+    if(framebuffer->background == NULL)
+    {
+        if(framebuffer->arena == NULL) framebuffer->background = new uint64_t[words];
+        else framebuffer->background = arena_array<uint64_t>(framebuffer->arena, words);
+        if(framebuffer->background == NULL) return false;
+    }
+
+    memcpy(framebuffer->background, layer->bits, words * sizeof(uint64_t));
+    memcpy(framebuffer->bits, layer->bits, words * sizeof(uint64_t));
+    framebuffer->dirty.clear();
+    return true;
+}
+
+void framebuffer_clear(framebuffer_t* framebuffer, framebuffer_clear_t mode)
+{
+    if(mode != CLEAR_DIRTY) framebuffer->touched += framebuffer->width * framebuffer->height;
+
+    switch(mode)
+    {
+        case CLEAR_NAIVE:
+            framebuffer_clear_naive(framebuffer);
+            break;
+        case CLEAR_MEMSET:
+            framebuffer_reset_bytes(framebuffer, 0, framebuffer_bytes(framebuffer));
+            break;
+        case CLEAR_STREAM:
+            framebuffer_clear_stream(framebuffer);
+            break;
+        case CLEAR_DIRTY:
+            framebuffer_clear_dirty(framebuffer);
+            break;
+    }
+
+    framebuffer->dirty.clear();
+}
+
+const char* framebuffer_clear_name(framebuffer_clear_t mode)
+{
+    switch(mode)
+    {
+        case CLEAR_NAIVE: return "naive";
+        case CLEAR_MEMSET: return "memset";
+        case CLEAR_STREAM: return "stream";
+        case CLEAR_DIRTY: return "dirty";
+    }
+    return "unknown";
+}
+
+static bool framebuffer_clip(const framebuffer_t* framebuffer, rect_t* rect)
+{
+    int x0 = rect->x < 0 ? 0 : rect->x;
+    int y0 = rect->y < 0 ? 0 : rect->y;
+    int x1 = rect->x + rect->w > framebuffer->width ? framebuffer->width : rect->x + rect->w;
+    int y1 = rect->y + rect->h > framebuffer->height ? framebuffer->height : rect->y + rect->h;
+    if(x0 >= x1 || y0 >= y1) return false;
+
+    *rect = {x0, y0, x1 - x0, y1 - y0};
+    return true;
+}
+
+void framebuffer_mark_dirty(framebuffer_t* framebuffer, rect_t rect)
+{
+    if(framebuffer_clip(framebuffer, &rect) == false) return;
+    framebuffer->dirty.push_back(rect);
+    framebuffer->touched += rect.w * rect.h;
+}
+
+void framebuffer_fill_rect(framebuffer_t* framebuffer, rect_t rect, bool on)
+{
+    if(framebuffer_clip(framebuffer, &rect) == false) return;
+
+    for (int y = rect.y; y < rect.y + rect.h; y++)
+    {
+        framebuffer_span(framebuffer, y, rect.x, rect.x + rect.w, on);
+    }
+    framebuffer->dirty.push_back(rect);
+    framebuffer->touched += rect.w * rect.h;
+}
+
+void framebuffer_erase_rect(framebuffer_t* framebuffer, rect_t rect)
+{
+    if(framebuffer_clip(framebuffer, &rect) == false) return;
+
+    for (int y = rect.y; y < rect.y + rect.h; y++)
+    {
+        framebuffer_restore_span(framebuffer, y, rect.x, rect.x + rect.w);
+    }
+    framebuffer->dirty.push_back(rect);
+    framebuffer->touched += rect.w * rect.h;
+}
+
+void framebuffer_compose(framebuffer_t* framebuffer, const framebuffer_t* const* layers, int count, rect_t rect)
+{
+    if(count <= 0 || framebuffer_clip(framebuffer, &rect) == false) return;
+
+    int first = rect.x / 64;
+    int last = (rect.x + rect.w - 1) / 64;
+    for (int y = rect.y; y < rect.y + rect.h; y++)
+    {
+        int offset = y * framebuffer->stride;
+        int word = first;
+
+#ifdef PONG_SIMD_X86
+        for (; word + 1 <= last; word += 2)
+        {
+            __m128i composed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers[0]->bits + offset + word));
+            for (int layer = 1; layer < count; layer++)
+            {
+                composed = _mm_or_si128(composed, _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers[layer]->bits + offset + word)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(framebuffer->bits + offset + word), composed);
+        }
+#endif
+        for (; word <= last; word++)
+        {
+            uint64_t composed = layers[0]->bits[offset + word];
+            for (int layer = 1; layer < count; layer++)
+            {
+                composed |= layers[layer]->bits[offset + word];
+            }
+            framebuffer->bits[offset + word] = composed;
+        }
+    }
+    framebuffer->touched += rect.w * rect.h;
+}
+
+void framebuffer_blit_row(framebuffer_t* framebuffer, int x, int y, uint64_t row_bits, int count)
+{
+    if(y < 0 || y >= framebuffer->height || count <= 0) return;
+
+    uint64_t bits = count < 64 ? row_bits & ((1ull << count) - 1) : row_bits;
+    if(x < 0)
+    {
+        if(x <= -count) return;
+        bits >>= -x;
+        x = 0;
+    }
+    if(x >= framebuffer->width) return;
+    if(x + count > framebuffer->width) bits &= (1ull << (framebuffer->width - x)) - 1;
+
+    // count is at most 64, so the shape spills into one more word at most
+    uint64_t* row = framebuffer->bits + y * framebuffer->stride;
+    int word = x / 64;
+    int shift = x % 64;
+    row[word] |= bits << shift;
+    if(shift != 0 && word + 1 < framebuffer->stride) row[word + 1] |= bits >> (64 - shift);
+}
+
+static constexpr void expand_pixel(unsigned char* pixel, bool on, int channels)
+{
+    unsigned char value = on ? 255 : 0;
+    pixel[0] = value;
+    pixel[1] = value;
+    pixel[2] = value;
+    if(channels == 4) pixel[3] = 255;
+}
+
+static void expand_row_scalar(const uint64_t* row, int begin, int width, unsigned char* out, int channels)
+{
+    for (int x = begin; x < width; x++)
+    {
+        expand_pixel(out + x * channels, (row[x / 64] >> (x % 64) & 1) != 0, channels);
+    }
+}
+
+// one row of width pixels; the SIMD kernels have the same shape
+static void expand_row_scalar(const uint64_t* row, int width, unsigned char* out, int channels)
+{
+    expand_row_scalar(row, 0, width, out, channels);
+}
+
+typedef void (*expand_row_t)(const uint64_t* row, int width, unsigned char* out, int channels);
+
+static void expand_rows(const framebuffer_t* framebuffer, unsigned char* pixels, int channels, expand_row_t expand_row)
+{
+    for (int y = 0; y < framebuffer->height; y++)
+    {
+        expand_row(framebuffer->bits + y * framebuffer->stride, framebuffer->width, pixels + y * framebuffer->width * channels, channels);
+    }
+}
+
+void framebuffer_expand_scalar(const framebuffer_t* framebuffer, unsigned char* pixels, int channels)
+{
+    expand_rows(framebuffer, pixels, channels, expand_row_scalar);
+}
+
+#ifdef PONG_SIMD_X86
+
+// Each byte of bits is 8 pixels; the SSE path copies their expansion from a table indexed by that byte,
+// the AVX2 path builds 32 output bytes at a time from 4 bytes of bits with a shuffle and a bit test.
+typedef struct
+{
+    alignas(16) unsigned char rgb[256][32];
+    alignas(16) unsigned char rgba[256][32];
+
+    // for output byte k of ymm c: which of the 4 bytes holds its pixel, and that pixel's bit
+    alignas(32) unsigned char rgb_bytes[3][32];
+    alignas(32) unsigned char rgb_bits[3][32];
+    alignas(32) unsigned char rgba_bytes[4][32];
+    alignas(32) unsigned char rgba_bits[4][32];
+} expand_tables_t;
+
+static constexpr expand_tables_t expand_tables_build()
+{
+    expand_tables_t tables = {};
+    for (int byte = 0; byte < 256; byte++)
+    {
+        for (int pixel = 0; pixel < 8; pixel++)
+        {
+            expand_pixel(tables.rgb[byte] + pixel * 3, (byte >> pixel & 1) != 0, 3);
+            expand_pixel(tables.rgba[byte] + pixel * 4, (byte >> pixel & 1) != 0, 4);
+        }
+    }
+
+    for (int k = 0; k < 4 * 32; k++)
+    {
+        if(k < 3 * 32)
+        {
+            tables.rgb_bytes[k / 32][k % 32] = static_cast<unsigned char>(k / 3 / 8);
+            tables.rgb_bits[k / 32][k % 32] = static_cast<unsigned char>(1 << (k / 3 % 8));
+        }
+        tables.rgba_bytes[k / 32][k % 32] = static_cast<unsigned char>(k / 4 / 8);
+        tables.rgba_bits[k / 32][k % 32] = static_cast<unsigned char>(1 << (k / 4 % 8));
+    }
+    return tables;
+}
+
+// built by the compiler, so nothing is allocated or initialised at run time
+static constexpr expand_tables_t EXPAND_TABLES = expand_tables_build();
+
+static void expand_row_sse(const uint64_t* row, int width, unsigned char* out, int channels)
+{
+    const expand_tables_t* tables = &EXPAND_TABLES;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(row);
+    int count = width / 8;
+    unsigned char* pixel = out;
+
+    if(channels == 4)
+    {
+        for (int i = 0; i < count; i++, pixel += 32)
+        {
+            const __m128i* expanded = reinterpret_cast<const __m128i*>(tables->rgba[bytes[i]]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), _mm_load_si128(expanded));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel + 16), _mm_load_si128(expanded + 1));
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++, pixel += 24)
+        {
+            const __m128i* expanded = reinterpret_cast<const __m128i*>(tables->rgb[bytes[i]]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), _mm_load_si128(expanded));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pixel + 16), _mm_load_si128(expanded + 1));
+        }
+    }
+
+    expand_row_scalar(row, count * 8, width, out, channels);
+}
+
+PONG_TARGET_AVX2 static void expand_row_avx2(const uint64_t* row, int width, unsigned char* out, int channels)
+{
+    const expand_tables_t* tables = &EXPAND_TABLES;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(row);
+    int groups = width / 32;
+    const unsigned char (*byte_index)[32] = channels == 4 ? tables->rgba_bytes : tables->rgb_bytes;
+    const unsigned char (*bit_index)[32] = channels == 4 ? tables->rgba_bits : tables->rgb_bits;
+
+    __m256i shuffles[4];
+    __m256i tests[4];
+    for (int c = 0; c < channels; c++)
+    {
+        shuffles[c] = _mm256_load_si256(reinterpret_cast<const __m256i*>(byte_index[c]));
+        tests[c] = _mm256_load_si256(reinterpret_cast<const __m256i*>(bit_index[c]));
+    }
+    // alpha stays opaque
+    __m256i alpha = channels == 4 ? _mm256_set1_epi32(static_cast<int>(0xFF000000u)) : _mm256_setzero_si256();
+
+    unsigned char* pixel = out;
+    for (int group = 0; group < groups; group++)
+    {
+        unsigned int bits;
+        memcpy(&bits, bytes + group * 4, sizeof(bits));
+        __m256i broadcast = _mm256_set1_epi32(static_cast<int>(bits));
+
+        for (int c = 0; c < channels; c++, pixel += 32)
+        {
+            __m256i selected = _mm256_and_si256(_mm256_shuffle_epi8(broadcast, shuffles[c]), tests[c]);
+            __m256i expanded = _mm256_or_si256(_mm256_cmpeq_epi8(selected, tests[c]), alpha);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixel), expanded);
+        }
+    }
+
+    expand_row_scalar(row, groups * 32, width, out, channels);
+}
+
+void framebuffer_expand_sse(const framebuffer_t* framebuffer, unsigned char* pixels, int channels)
+{
+    expand_rows(framebuffer, pixels, channels, expand_row_sse);
+}
+
+void framebuffer_expand_avx2(const framebuffer_t* framebuffer, unsigned char* pixels, int channels)
+{
+    expand_rows(framebuffer, pixels, channels, expand_row_avx2);
+}
+
+#else
+
+static void expand_row_sse(const uint64_t* row, int width, unsigned char* out, int channels)
+{
+    expand_row_scalar(row, width, out, channels);
+}
+
+static void expand_row_avx2(const uint64_t* row, int width, unsigned char* out, int channels)
+{
+    expand_row_scalar(row, width, out, channels);
+}
+
+void framebuffer_expand_sse(const framebuffer_t* framebuffer, unsigned char* pixels, int channels)
+{
+    framebuffer_expand_scalar(framebuffer, pixels, channels);
+}
+
+void framebuffer_expand_avx2(const framebuffer_t* framebuffer, unsigned char* pixels, int channels)
+{
+    framebuffer_expand_scalar(framebuffer, pixels, channels);
+}
+
+#endif
+
+void framebuffer_expand(simd_isa_t isa, const framebuffer_t* framebuffer, unsigned char* pixels, int channels)
+{
+    switch(isa)
+    {
+        case SIMD_AVX2:
+            framebuffer_expand_avx2(framebuffer, pixels, channels);
+            break;
+        case SIMD_SSE:
+            framebuffer_expand_sse(framebuffer, pixels, channels);
+            break;
+        default:
+            framebuffer_expand_scalar(framebuffer, pixels, channels);
+            break;
+    }
+}
+
+void framebuffer_upscale_naive(const framebuffer_t* framebuffer, int factor, unsigned char* pixels, int channels)
+{
+    int width = framebuffer->width * factor;
+    int height = framebuffer->height * factor;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            expand_pixel(pixels + (x + y * width) * channels, framebuffer_get(framebuffer, x / factor, y / factor), channels);
+        }
+    }
+}
+
+static inline int lowest_bit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while((bits >> bit & 1) == 0) bit++;
+    return bit;
+#endif
+}
+
+// Each run of set pixels in row becomes a run factor times as long in scaled, which starts cleared.
+// Runs are found a word at a time, so mostly black frames cost next to nothing.
+static void widen_row(const uint64_t* row, int width, int factor, uint64_t* scaled)
+{
+    for (int word = 0; word * 64 < width; word++)
+    {
+        uint64_t bits = row[word];
+        if(width - word * 64 < 64) bits &= (1ull << (width - word * 64)) - 1;
+
+        while(bits != 0)
+        {
+            int begin = lowest_bit(bits);
+            uint64_t clear = ~bits & ~0ull << begin;
+            int end = clear == 0 ? 64 : lowest_bit(clear);
+            row_span(scaled, (word * 64 + begin) * factor, (word * 64 + end) * factor, true);
+            bits = end == 64 ? 0 : bits & ~0ull << end;
+        }
+    }
+}
+
+static void upscale_rows(const framebuffer_t* framebuffer, int factor, unsigned char* pixels, int channels, uint64_t* scaled, expand_row_t expand_row)
+{
+    int width = framebuffer->width * factor;
+    int words = (width + 63) / 64;
+    size_t row_bytes = static_cast<size_t>(width) * channels;
+
+    for (int y = 0; y < framebuffer->height; y++)
+    {
+        memset(scaled, 0, words * sizeof(uint64_t));
+        widen_row(framebuffer->bits + y * framebuffer->stride, framebuffer->width, factor, scaled);
+
+        unsigned char* out = pixels + y * factor * row_bytes;
+        expand_row(scaled, width, out, channels);
+        for (int copy = 1; copy < factor; copy++)
+        {
+            memcpy(out + copy * row_bytes, out, row_bytes);
+        }
+    }
+}
+
+bool framebuffer_upscale(simd_isa_t isa, const framebuffer_t* framebuffer, int factor, unsigned char* pixels, int channels, arena_t* scratch)
+{
+    size_t mark = scratch->used;
+    uint64_t* scaled = arena_array<uint64_t>(scratch, (framebuffer->width * factor + 63) / 64);
+    if(scaled == NULL) return false;
+
+    switch(isa)
+    {
+        case SIMD_AVX2:
+            upscale_rows(framebuffer, factor, pixels, channels, scaled, expand_row_avx2);
+            break;
+        case SIMD_SSE:
+            upscale_rows(framebuffer, factor, pixels, channels, scaled, expand_row_sse);
+            break;
+        default:
+            upscale_rows(framebuffer, factor, pixels, channels, scaled, expand_row_scalar);
+            break;
+    }
+
+    arena_rewind(scratch, mark);
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef PONG_FRAMEBUFFER_H
+#define PONG_FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "simd.h"
+#include "arena.h"
+
+typedef struct
+{
+    int x, y, w, h;
+} rect_t;
+
+typedef enum
+{
+    CLEAR_NAIVE,    // pixel by pixel, column by column, kept as the baseline
+    CLEAR_MEMSET,
+    CLEAR_STREAM,   // non-temporal stores, skipping the cache for buffers larger than it
+    CLEAR_DIRTY     // only the rects drawn since the last clear
+} framebuffer_clear_t;
+
+// dirty rects a framebuffer has room for before its list grows on the heap
+const int FRAMEBUFFER_DIRTY_RESERVE = 64;
+
+// Monochrome, one bit per pixel: pixel x of a row is bit x % 64 of word x / 64, bottom row first as
+// glDrawPixels expects. Fills are word-wide masks and record their rect, so a dirty clear can undo
+// exactly what was drawn, back to the background if there is one. Colour only exists once
+// framebuffer_expand writes it out for presenting.
+typedef struct
+{
+    int width, height;
+    int stride; // words per row
+    uint64_t* bits;
+    std::vector<rect_t> dirty;
+
+    // static layer that clears and erases restore instead of switching pixels off; NULL is all off
+    uint64_t* background;
+    // where bits and background came from; NULL is the heap
+    arena_t* arena;
+
+    // pixels cleared or drawn since the caller last reset it
+    long long touched;
+} framebuffer_t;
+
+void framebuffer_init(framebuffer_t* framebuffer, int width, int height);
+// Takes bits from arena instead of the heap; false, with nothing taken, when it doesn't fit.
+bool framebuffer_init_arena(framebuffer_t* framebuffer, int width, int height, arena_t* arena);
+void framebuffer_destroy(framebuffer_t* framebuffer);
+
+inline int framebuffer_bytes(const framebuffer_t* framebuffer)
+{
+    return framebuffer->stride * framebuffer->height * static_cast<int>(sizeof(uint64_t));
+}
+
+// Caches layer's pixels, which has to be the same size, as the background and shows it; false when
+// the framebuffer's arena has no room for it.
+bool framebuffer_set_background(framebuffer_t* framebuffer, const framebuffer_t* layer);
+
+void framebuffer_clear(framebuffer_t* framebuffer, framebuffer_clear_t mode);
+const char* framebuffer_clear_name(framebuffer_clear_t mode);
+
+// clipped to the framebuffer
+void framebuffer_fill_rect(framebuffer_t* framebuffer, rect_t rect, bool on);
+// back to the background inside rect; clipped and recorded as dirty like a fill
+void framebuffer_erase_rect(framebuffer_t* framebuffer, rect_t rect);
+// ORs count (up to 64) pixels of row_bits, lowest bit leftmost, into row y from column x; clipped,
+// and not recorded as dirty, callers mark the whole shape once
+void framebuffer_blit_row(framebuffer_t* framebuffer, int x, int y, uint64_t row_bits, int count);
+void framebuffer_mark_dirty(framebuffer_t* framebuffer, rect_t rect);
+// Every pixel inside rect becomes the OR of that pixel in count layers of the same size. Whole words
+// are composed, so the framebuffer has to be their composite outside rect too. Not recorded as dirty.
+void framebuffer_compose(framebuffer_t* framebuffer, const framebuffer_t* const* layers, int count, rect_t rect);
+
+inline bool framebuffer_get(const framebuffer_t* framebuffer, int x, int y)
+{
+    return (framebuffer->bits[y * framebuffer->stride + x / 64] >> (x % 64) & 1) != 0;
+}
+
+// Writes width * height pixels of channels (3 for RGB, 4 for RGBA) bytes, 0 or 255, to pixels.
+// Every path writes the same bytes; pong_headless expand checks that.
+void framebuffer_expand_scalar(const framebuffer_t* framebuffer, unsigned char* pixels, int channels);
+void framebuffer_expand_sse(const framebuffer_t* framebuffer, unsigned char* pixels, int channels);
+void framebuffer_expand_avx2(const framebuffer_t* framebuffer, unsigned char* pixels, int channels);
+
+void framebuffer_expand(simd_isa_t isa, const framebuffer_t* framebuffer, unsigned char* pixels, int channels);
+
+// Nearest-neighbour expansion scaled up by a whole factor, (width * factor) x (height * factor) pixels.
+// Each row is widened in bits, expanded once by the isa's kernel and copied to the factor - 1 rows
+// above it; the naive path looks up every output pixel and is kept as the baseline. The widened row
+// is borrowed from scratch and given back before returning; false when scratch has no room for it.
+void framebuffer_upscale_naive(const framebuffer_t* framebuffer, int factor, unsigned char* pixels, int channels);
+bool framebuffer_upscale(simd_isa_t isa, const framebuffer_t* framebuffer, int factor, unsigned char* pixels, int channels, arena_t* scratch);
+
+inline bool rect_equal(rect_t a, rect_t b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+inline bool rect_overlap(rect_t a, rect_t b)
+{
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include <chrono>
+
+#include "game.h"
+#include "profiler.h"
+
+static double game_seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool game_init(game_t* game, int tick_rate, unsigned int seed)
+{
+    simulation_init(&game->simulation, seed);
+    simulation_clock_init(&game->clock, tick_rate);
+    simulation_latch_init(&game->latch);
+    arena_init(&game->persistent, GAME_PERSISTENT_BYTES);
+    arena_init(&game->frame, GAME_FRAME_BYTES);
+
+    game->simulation_seconds = 0.0;
+    game->render_seconds = 0.0;
+    game->frames = 0;
+
+    game->framebuffer = {};
+    game->layers = {};
+    if(framebuffer_init_arena(&game->framebuffer, PIXELS_WIDTH, PIXELS_HEIGHT, &game->persistent) == false) return false;
+    return render_layers_init(&game->layers, PIXELS_WIDTH, PIXELS_HEIGHT, &game->persistent);
+}
+
+void game_destroy(game_t* game)
+{
+    render_layers_destroy(&game->layers);
+    framebuffer_destroy(&game->framebuffer);
+    arena_destroy(&game->frame);
+    arena_destroy(&game->persistent);
+}
+
+static void game_simulate_source(game_t* game, simulation_input_source_t source, void* context, double frame_time)
+{
+    PROFILE_ZONE("simulate");
+    arena_reset(&game->frame);
+
+    auto start = std::chrono::steady_clock::now();
+    simulation_advance_source(&game->simulation, &game->clock, source, context, frame_time);
+    simulation_interpolate(&game->simulation, game->clock.alpha);
+    game->simulation_seconds += game_seconds(start);
+}
+
+void game_simulate(game_t* game, simulation_inputs_t inputs, double frame_time)
+{
+    game_simulate_source(game, simulation_constant_inputs, &inputs, frame_time);
+}
+
+void game_simulate_events(game_t* game, input_reader_t* reader, double frame_time)
+{
+    reader->frame_end = input_time();
+    game_simulate_source(game, input_reader_tick, reader, frame_time);
+}
+
+void game_latch(game_t* game, input_reader_t* reader)
+{
+    PROFILE_ZONE("latch");
+    simulation_inputs_t inputs = input_reader_latch(reader, input_time());
+    simulation_latch_paddles(&game->simulation, &game->latch, inputs, &game->clock);
+}
+
+void game_present(game_t* game, presenter_t* presenter, input_reader_t* reader)
+{
+    auto start = std::chrono::steady_clock::now();
+    renderer_layered(&game->simulation, &game->framebuffer, &game->layers);
+    game->render_seconds += game_seconds(start);
+    game->rendered_at = input_time();
+
+    {
+        PROFILE_ZONE("present");
+        presenter_present(presenter, &game->framebuffer, &game->frame);
+    }
+    game->presented_at = input_time();
+    game->frames++;
+
+    if(reader != NULL) input_reader_frame(reader, game->rendered_at, game->presented_at);
+}
+
+void game_frame(game_t* game, presenter_t* presenter, simulation_inputs_t inputs, double frame_time)
+{
+    game_simulate(game, inputs, frame_time);
+    game_present(game, presenter, NULL);
+}
+
+void game_frame_events(game_t* game, presenter_t* presenter, input_reader_t* reader, double frame_time)
+{
+    game_simulate_events(game, reader, frame_time);
+    game_present(game, presenter, reader);
+}
@@ -0,0 +1,57 @@
+#ifndef PONG_GAME_H
+#define PONG_GAME_H
+
+#include "simulation.h"
+#include "renderer.h"
+#include "presenter.h"
+#include "arena.h"
+#include "input.h"
+
+const size_t GAME_PERSISTENT_BYTES = 16 * 1024;
+const size_t GAME_FRAME_BYTES = 16 * 1024;
+
+// Everything one frame of the game needs besides a platform: simulation, fixed tick clock, the render
+// layers and the framebuffer they are composed into. The window and the headless loop both drive it
+// with game_frame.
+typedef struct
+{
+    simulation_state_t simulation;
+    simulation_clock_t clock;
+    simulation_latch_t latch;
+    framebuffer_t framebuffer;
+    render_layers_t layers;
+
+    arena_t persistent; // framebuffer and layers
+    arena_t frame;      // scratch, reset at the start of every frame
+
+    // where frame time goes, split by stage
+    double simulation_seconds;
+    double render_seconds;
+    long long frames;
+
+    // input_time the last frame finished rendering and presenting
+    long long rendered_at;
+    long long presented_at;
+} game_t;
+
+// false when the persistent arena is too small for the framebuffer and layers; game_destroy still
+// has to be called
+bool game_init(game_t* game, int tick_rate, unsigned int seed);
+void game_destroy(game_t* game);
+
+// advances the simulation by frame_time, renders the interpolated state and presents it
+void game_frame(game_t* game, presenter_t* presenter, simulation_inputs_t inputs, double frame_time);
+// the same with every tick's inputs read from the reader's event ring, the frame ending now, and the
+// consumed events traced through to the present
+void game_frame_events(game_t* game, presenter_t* presenter, input_reader_t* reader, double frame_time);
+
+// The same frames in stages, for a platform loop that polls again between them.
+void game_simulate(game_t* game, simulation_inputs_t inputs, double frame_time);
+void game_simulate_events(game_t* game, input_reader_t* reader, double frame_time);
+// Late latch: after one more poll, draws the paddles moved by the newest keys rather than the last
+// tick's, still level in time with the ball. Call between simulating and presenting, every frame.
+void game_latch(game_t* game, input_reader_t* reader);
+// renders and presents; with a reader, closes the traces of the events this frame shows
+void game_present(game_t* game, presenter_t* presenter, input_reader_t* reader);
+
+#endif
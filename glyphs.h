@@ -0,0 +1,55 @@
+#ifndef PONG_GLYPHS_H
+#define PONG_GLYPHS_H
+
+#include <stdint.h>
+
+const int GLYPH_WIDTH = 3;
+const int GLYPH_HEIGHT = 5;
+const int GLYPH_ADVANCE = GLYPH_WIDTH + 1;
+
+// Packs a glyph drawn as '1' for lit and '0' for blank, row by row from the top, into bit
+// row * GLYPH_WIDTH + column, column 0 leftmost.
+constexpr uint16_t glyph(const char (&rows)[GLYPH_WIDTH * GLYPH_HEIGHT + 1])
+{
+    uint16_t bits = 0;
+    for (int i = 0; i < GLYPH_WIDTH * GLYPH_HEIGHT; i++)
+    {
+        if(rows[i] == '1') bits = static_cast<uint16_t>(bits | 1 << i);
+    }
+    return bits;
+}
+
+constexpr uint16_t DIGIT_GLYPHS[10] = {
+    glyph("111" "101" "101" "101" "111"),
+    glyph("001" "001" "001" "001" "001"),
+    glyph("111" "001" "111" "100" "111"),
+    glyph("111" "001" "111" "001" "111"),
+    glyph("101" "101" "111" "001" "001"),
+    glyph("111" "100" "111" "001" "111"),
+    glyph("111" "100" "111" "101" "111"),
+    glyph("111" "001" "001" "001" "001"),
+    glyph("111" "101" "111" "101" "111"),
+    glyph("111" "101" "111" "001" "001"),
+};
+
+static_assert(DIGIT_GLYPHS[8] == 0x7BEF, "glyph bits are row * GLYPH_WIDTH + column");
+
+constexpr unsigned int glyph_row(uint16_t glyph, int row)
+{
+    return glyph >> (row * GLYPH_WIDTH) & ((1u << GLYPH_WIDTH) - 1);
+}
+
+constexpr int number_digits(int number)
+{
+    return number < 10 ? 1 : 1 + number_digits(number / 10);
+}
+
+constexpr int number_width(int number)
+{
+    return number_digits(number) * GLYPH_ADVANCE - 1;
+}
+
+// 10 digits of an int are 39 columns, so a whole number row fits in one blit
+static_assert(10 * GLYPH_ADVANCE <= 64, "a number row has to fit in a 64-bit blit");
+
+#endif
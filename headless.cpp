@@ -0,0 +1,1543 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <mutex>
+
+#include "simulation.h"
+#include "batch.h"
+#include "batch_kernels.h"
+#include "scheduler.h"
+#include "framebuffer.h"
+#include "renderer.h"
+#include "game.h"
+#include "pacer.h"
+#include "profiler.h"
+
+// Counts heap allocations, to prove the game loop stays off the heap. Where the C library lets a
+// program replace malloc (glibc, without a sanitizer that replaces it first) every C allocation is
+// counted there and operator new, aligned or not, goes through it; elsewhere operator new counts.
+std::atomic<long long> headless_allocations(0);
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define HEADLESS_COUNT_MALLOC
+
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* memory, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+void __libc_free(void* memory);
+
+void* malloc(size_t size)
+{
+    headless_allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    headless_allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* memory, size_t size)
+{
+    headless_allocations++;
+    return __libc_realloc(memory, size);
+}
+
+void* memalign(size_t align, size_t size)
+{
+    headless_allocations++;
+    return __libc_memalign(align, size);
+}
+
+void* aligned_alloc(size_t align, size_t size)
+{
+    headless_allocations++;
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void** memory, size_t align, size_t size)
+{
+    headless_allocations++;
+    *memory = __libc_memalign(align, size);
+    return *memory == NULL ? ENOMEM : 0;
+}
+
+void free(void* memory)
+{
+    __libc_free(memory);
+}
+}
+#endif
+
+static void* headless_new(size_t size, size_t align)
+{
+#ifndef HEADLESS_COUNT_MALLOC
+    headless_allocations++;
+#endif
+    if(size == 0) size = 1;
+    if(align <= alignof(max_align_t)) return malloc(size);
+
+    // aligned_alloc wants a whole number of alignments
+    return aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+void* operator new(size_t size)
+{
+    void* memory = headless_new(size, 0);
+    if(memory == NULL) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new(size_t size, std::align_val_t align)
+{
+    void* memory = headless_new(size, static_cast<size_t>(align));
+    if(memory == NULL) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return headless_new(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return headless_new(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+// Scripted player: starts matches and tracks the ball, missing now and then so points get scored.
+// It draws from its own generator so the match generator stays untouched.
+simulation_inputs_t headless_player(game_state_t game_state, float ball_y, float left_y, float right_y, unsigned int* random)
+{
+    simulation_inputs_t inputs = {};
+
+    if(game_state == IDLE)
+    {
+        inputs.enter = 1;
+        return inputs;
+    }
+
+    float left_center = left_y + PADDLE_HEIGHT / 2;
+    float right_center = right_y + PADDLE_HEIGHT / 2;
+
+    if(simulation_random(random) % 4 != 0)
+    {
+        inputs.left_paddle_up = ball_y > left_center;
+        inputs.left_paddle_down = ball_y < left_center;
+    }
+    if(simulation_random(random) % 4 != 0)
+    {
+        inputs.right_paddle_up = ball_y > right_center;
+        inputs.right_paddle_down = ball_y < right_center;
+    }
+
+    return inputs;
+}
+
+simulation_inputs_t headless_inputs(simulation_state_t* state, unsigned int* random)
+{
+    entity_manager_t* entity_manager = &state->entity_manager;
+    return headless_player(state->game_state,
+        get_position(entity_manager, state->ball)->y,
+        get_position(entity_manager, state->left_paddle)->y,
+        get_position(entity_manager, state->right_paddle)->y,
+        random);
+}
+
+simulation_inputs_t headless_batch_inputs(match_batch_t* batch, int match, unsigned int* random)
+{
+    return headless_player(batch->game_states[match],
+        batch->y[batch_ball(batch, match)],
+        batch->y[batch_left_paddle(batch, match)],
+        batch->y[batch_right_paddle(batch, match)],
+        random);
+}
+
+unsigned int headless_checksum(simulation_state_t* state)
+{
+    entity_manager_t* entity_manager = &state->entity_manager;
+    unsigned int hash = 2166136261u;
+    entity_t entities[3] = {state->left_paddle, state->right_paddle, state->ball};
+    for (int i = 0; i < 3; i++)
+    {
+        position_t position = *get_position(entity_manager, entities[i]);
+        hash = (hash ^ static_cast<unsigned int>(position.pixel_x)) * 16777619u;
+        hash = (hash ^ static_cast<unsigned int>(position.pixel_y)) * 16777619u;
+    }
+    hash = (hash ^ static_cast<unsigned int>(state->left_score)) * 16777619u;
+    hash = (hash ^ static_cast<unsigned int>(state->right_score)) * 16777619u;
+    hash = (hash ^ static_cast<unsigned int>(state->matches)) * 16777619u;
+    return hash;
+}
+
+double headless_seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a game that doesn't fit its arenas is a sizing bug, not something to measure around
+void headless_game_init(game_t* game)
+{
+    if(game_init(game, DEFAULT_TICK_RATE, 1)) return;
+
+    fprintf(stderr, "the game doesn't fit in its arenas\n");
+    exit(1);
+}
+
+// pong_headless run [matches] [seed] [tick_rate]
+int headless_run(int argc, char **argv)
+{
+    int matches = argc > 0 ? atoi(argv[0]) : 1000;
+    unsigned int seed = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 1;
+    int tick_rate = argc > 2 ? atoi(argv[2]) : DEFAULT_TICK_RATE;
+
+    if(matches <= 0 || tick_rate <= 0) return -1;
+
+    simulation_state_t simulation;
+    simulation_init(&simulation, seed);
+
+    simulation_clock_t simulation_clock;
+    simulation_clock_init(&simulation_clock, tick_rate);
+
+    unsigned int player_random = seed;
+    long long ticks = 0;
+    auto start = std::chrono::steady_clock::now();
+    while(simulation.matches < matches)
+    {
+        simulation_step(&simulation, headless_inputs(&simulation, &player_random), static_cast<float>(simulation_clock.tick_dt));
+        ticks++;
+    }
+    double seconds = headless_seconds(start);
+
+    printf("matches: %d\n", simulation.matches);
+    printf("ticks: %lld\n", ticks);
+    printf("seconds: %.3f\n", seconds);
+    printf("matches/s: %.0f\n", simulation.matches / seconds);
+    printf("ticks/s: %.0f\n", ticks / seconds);
+    printf("checksum: %08x\n", headless_checksum(&simulation));
+
+    return 0;
+}
+
+// pong_headless batch [matches] [ticks] [seed]
+int headless_batch(int argc, char **argv)
+{
+    int matches = argc > 0 ? atoi(argv[0]) : 10000;
+    int ticks = argc > 1 ? atoi(argv[1]) : 10000;
+    unsigned int seed = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : 1;
+
+    if(matches <= 0 || ticks <= 0) return -1;
+
+    match_batch_t batch;
+    batch_init(&batch, matches, seed);
+
+    simulation_clock_t simulation_clock;
+    simulation_clock_init(&simulation_clock, DEFAULT_TICK_RATE);
+
+    simulation_inputs_t* inputs = new simulation_inputs_t[matches];
+    unsigned int* player_random = new unsigned int[matches];
+    for (int match = 0; match < matches; match++)
+    {
+        player_random[match] = seed + match;
+    }
+
+    double input_seconds = 0.0;
+    double step_seconds = 0.0;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int match = 0; match < matches; match++)
+        {
+            inputs[match] = headless_batch_inputs(&batch, match, &player_random[match]);
+        }
+        input_seconds += headless_seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        batch_step(&batch, inputs, static_cast<float>(simulation_clock.tick_dt));
+        step_seconds += headless_seconds(start);
+    }
+
+    long long finished = 0;
+    for (int match = 0; match < matches; match++)
+    {
+        finished += batch.matches[match];
+    }
+
+    double match_ticks = static_cast<double>(matches) * ticks;
+    printf("matches: %d\n", matches);
+    printf("ticks: %d\n", ticks);
+    printf("finished matches: %lld\n", finished);
+    printf("step seconds: %.3f\n", step_seconds);
+    printf("input seconds: %.3f\n", input_seconds);
+    printf("match ticks/s: %.0f\n", match_ticks / step_seconds);
+
+    delete[] player_random;
+    delete[] inputs;
+    batch_destroy(&batch);
+
+    return 0;
+}
+
+// pong_headless verify [matches] [ticks] [seed]
+// Steps the batch next to one simulation_state_t per match and compares them after every tick.
+int headless_verify(int argc, char **argv)
+{
+    int matches = argc > 0 ? atoi(argv[0]) : 64;
+    int ticks = argc > 1 ? atoi(argv[1]) : 20000;
+    unsigned int seed = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : 1;
+
+    if(matches <= 0 || ticks <= 0) return -1;
+
+    match_batch_t batch;
+    batch_init(&batch, matches, seed);
+
+    simulation_state_t* simulations = new simulation_state_t[matches];
+    simulation_inputs_t* inputs = new simulation_inputs_t[matches];
+    unsigned int* player_random = new unsigned int[matches];
+    for (int match = 0; match < matches; match++)
+    {
+        simulation_init(&simulations[match], seed + match);
+        player_random[match] = seed + match;
+    }
+
+    simulation_clock_t simulation_clock;
+    simulation_clock_init(&simulation_clock, DEFAULT_TICK_RATE);
+
+    int mismatches = 0;
+    for (int tick = 0; tick < ticks && mismatches == 0; tick++)
+    {
+        for (int match = 0; match < matches; match++)
+        {
+            inputs[match] = headless_inputs(&simulations[match], &player_random[match]);
+            simulation_step(&simulations[match], inputs[match], static_cast<float>(simulation_clock.tick_dt));
+        }
+        batch_step(&batch, inputs, static_cast<float>(simulation_clock.tick_dt));
+
+        for (int match = 0; match < matches; match++)
+        {
+            simulation_state_t* state = &simulations[match];
+            entity_manager_t* entity_manager = &state->entity_manager;
+            entity_t entities[3] = {state->left_paddle, state->right_paddle, state->ball};
+            int lanes[3] = {batch_left_paddle(&batch, match), batch_right_paddle(&batch, match), batch_ball(&batch, match)};
+
+            bool equal = state->game_state == batch.game_states[match] &&
+                state->left_score == batch.left_scores[match] &&
+                state->right_score == batch.right_scores[match] &&
+                state->random == batch.random[match];
+
+            for (int i = 0; i < 3; i++)
+            {
+                position_t position = *get_position(entity_manager, entities[i]);
+                movement_t movement = *get_movement(entity_manager, entities[i]);
+                int entity = lanes[i];
+
+                equal = equal &&
+                    memcmp(&position.x, &batch.x[entity], sizeof(float)) == 0 &&
+                    memcmp(&position.y, &batch.y[entity], sizeof(float)) == 0 &&
+                    position.pixel_x == batch.pixel_x[entity] &&
+                    position.pixel_y == batch.pixel_y[entity] &&
+                    memcmp(&movement.dir_x, &batch.dir_x[entity], sizeof(float)) == 0 &&
+                    memcmp(&movement.dir_y, &batch.dir_y[entity], sizeof(float)) == 0 &&
+                    get_renderer(entity_manager, entities[i])->visible == (batch.visible[entity] != 0);
+            }
+
+            if(equal == false)
+            {
+                fprintf(stderr, "match %d diverged at tick %d\n", match, tick);
+                mismatches++;
+            }
+        }
+    }
+
+    delete[] player_random;
+    delete[] inputs;
+    delete[] simulations;
+    batch_destroy(&batch);
+
+    printf("verify: %s\n", mismatches == 0 ? "ok" : "FAILED");
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Random entity data, so the kernels see fractional speeds and every direction instead of one game's worth.
+// Paddles stay on their columns so balls still run into them.
+void headless_scramble(match_batch_t* batch, unsigned int seed)
+{
+    unsigned int random = seed;
+    for (int entity = 0; entity < batch->entity_count; entity++)
+    {
+        bool paddle = entity < 2 * batch->count;
+        float column = entity < batch->count ? LEFT_PADDLE_RESOURCE.x : RIGHT_PADDLE_RESOURCE.x;
+
+        batch->x[entity] = paddle ? column : simulation_random(&random) % (PIXELS_WIDTH * 16) / 16.0f;
+        batch->y[entity] = simulation_random(&random) % (PIXELS_HEIGHT * 16) / 16.0f;
+        batch->dir_x[entity] = paddle ? 0.0f : static_cast<float>(simulation_random(&random) % 3 - 1);
+        batch->dir_y[entity] = static_cast<float>(simulation_random(&random) % 3 - 1);
+        batch->speed[entity] = simulation_random(&random) % 1000 / 10.0f;
+        batch->visible[entity] = simulation_random(&random) % 4 != 0;
+    }
+}
+
+bool headless_same(const void* a, const void* b, int count, size_t size)
+{
+    return memcmp(a, b, count * size) == 0;
+}
+
+bool headless_batch_equal(match_batch_t* a, match_batch_t* b)
+{
+    int entities = a->entity_count;
+    return headless_same(a->x, b->x, entities, sizeof(float)) &&
+        headless_same(a->y, b->y, entities, sizeof(float)) &&
+        headless_same(a->previous_x, b->previous_x, entities, sizeof(float)) &&
+        headless_same(a->previous_y, b->previous_y, entities, sizeof(float)) &&
+        headless_same(a->pixel_x, b->pixel_x, entities, sizeof(int)) &&
+        headless_same(a->pixel_y, b->pixel_y, entities, sizeof(int)) &&
+        headless_same(a->dir_x, b->dir_x, entities, sizeof(float)) &&
+        headless_same(a->dir_y, b->dir_y, entities, sizeof(float));
+}
+
+// Runs one kernel for every instruction set available and compares each result with the scalar run.
+// With balls set, every iteration moves the entities first and only the ball pass is timed.
+bool headless_bench_kernel(const char* name, bool balls, int matches, int iterations)
+{
+    const float dt = 1.0f / 144.0f;
+    simd_isa_t widest = simd_detect();
+
+    match_batch_t reference = {};
+    bool identical = true;
+    for (int isa = SIMD_SCALAR; isa <= widest; isa++)
+    {
+        simd_isa_t kernel_isa = static_cast<simd_isa_t>(isa);
+
+        match_batch_t batch;
+        batch_init(&batch, matches, 1);
+        headless_scramble(&batch, 7);
+
+        double seconds = 0.0;
+        for (int i = 0; i < iterations; i++)
+        {
+            if(balls)
+            {
+                movement_kernel(kernel_isa, &batch, 0, batch.entity_count, dt);
+
+                auto start = std::chrono::steady_clock::now();
+                ball_kernel(kernel_isa, &batch, 0, batch.count);
+                seconds += headless_seconds(start);
+            }
+            else
+            {
+                auto start = std::chrono::steady_clock::now();
+                movement_kernel(kernel_isa, &batch, 0, batch.entity_count, dt);
+                seconds += headless_seconds(start);
+            }
+        }
+
+        bool same = true;
+        if(kernel_isa == SIMD_SCALAR)
+        {
+            reference = batch;
+        }
+        else
+        {
+            same = headless_batch_equal(&batch, &reference);
+            identical = identical && same;
+            batch_destroy(&batch);
+        }
+
+        long long items = static_cast<long long>(balls ? matches : matches * 3) * iterations;
+        printf("%-8s %-6s %8.1f M %s/s %s\n", name, kernel_isa == SIMD_SCALAR && balls ? "branchy" : simd_isa_name(kernel_isa),
+            items / seconds / 1e6, balls ? "balls" : "entities",
+            kernel_isa == SIMD_SCALAR ? "" : same ? "identical" : "MISMATCH");
+    }
+
+    batch_destroy(&reference);
+    return identical;
+}
+
+// pong_headless kernels [matches] [iterations]
+// Runs each vectorized kernel available on this CPU against the scalar one on identical data.
+int headless_kernels(int argc, char **argv)
+{
+    int matches = argc > 0 ? atoi(argv[0]) : 10000;
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000;
+
+    if(matches <= 0 || iterations <= 0) return -1;
+
+    bool identical = headless_bench_kernel("movement", false, matches, iterations);
+    identical = headless_bench_kernel("ball", true, matches, iterations) && identical;
+
+    return identical ? 0 : 1;
+}
+
+// pong_headless entities [count] [ticks]
+// Spawns count particles every tick and despawns the previous tick's, checking that stale handles are
+// rejected and that the manager stops growing once the free list is warm.
+int headless_entities(int argc, char **argv)
+{
+    int count = argc > 0 ? atoi(argv[0]) : 1000;
+    int ticks = argc > 1 ? atoi(argv[1]) : 1000;
+
+    if(count <= 0 || ticks <= 1) return -1;
+
+    entity_manager_t entity_manager = {};
+    entity_resource_t particle_rsc = {PIXELS_WIDTH / 2, PIXELS_HEIGHT / 2, 1, 1, ENTITY_SPEED, true};
+    std::vector<entity_t> particles(count, NULL_ENTITY);
+    std::vector<entity_t> stale(count, NULL_ENTITY);
+
+    size_t warm_capacity = 0;
+    bool stale_rejected = true;
+    double seconds = 0.0;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            stale[i] = particles[i];
+            destroy_entity(&entity_manager, particles[i]);
+
+            particles[i] = create_entity(&entity_manager, component_signature<extension_t, position_t, movement_t>());
+            setup_component(&entity_manager, particles[i], particle_rsc);
+        }
+        movement_system(&entity_manager, 1.0f / DEFAULT_TICK_RATE);
+        seconds += headless_seconds(start);
+
+        for (int i = 0; i < count; i++)
+        {
+            stale_rejected = stale_rejected && get_position(&entity_manager, stale[i]) == nullptr;
+        }
+
+        size_t capacity = entity_manager.generations.capacity() + entity_manager.free_indices.capacity() +
+            entity_manager.locations.capacity() + entity_manager.archetypes.capacity();
+        for (int a = 0; a < static_cast<int>(entity_manager.archetypes.size()); a++)
+        {
+            capacity += entity_manager.archetypes[a].chunks.size();
+        }
+        if(tick == 1) warm_capacity = capacity;
+        if(tick > 1 && capacity != warm_capacity) warm_capacity = 0;
+    }
+
+    // a system may create queries while another one is being iterated; none of them may move
+    const query_t* iterated = entity_query(&entity_manager, component_signature<position_t>());
+    bool queries_stable = true;
+    entity_each<position_t>(&entity_manager, [&](int, position_t*)
+    {
+        for (signature_t signature = 1; signature < component_bit(static_cast<component_uid_t>(COMPONENT_TYPES)); signature++)
+        {
+            entity_query(&entity_manager, signature);
+        }
+        queries_stable = queries_stable && entity_query(&entity_manager, component_signature<position_t>()) == iterated;
+    });
+
+    printf("entities: %d alive, %d slots\n", entity_manager.alive, static_cast<int>(entity_manager.generations.size()));
+    printf("spawn + despawn: %.1f ns\n", seconds / (static_cast<double>(count) * ticks) * 1e9);
+    printf("stale handles: %s\n", stale_rejected ? "rejected" : "ACCEPTED");
+    printf("steady state growth: %s\n", warm_capacity != 0 ? "none" : "GREW");
+    printf("queries created while iterating: %s\n", queries_stable ? "none moved" : "MOVED");
+
+    return stale_rejected && warm_capacity != 0 && queries_stable ? 0 : 1;
+}
+
+// pong_headless handles
+// Drives the entity handles to both of their limits: one slot is reused until its generations run out,
+// and then every slot is filled. No stale handle may come back to life, the exhausted slot must be
+// retired rather than wrapped, and creating past the last slot has to fail.
+int headless_handles(int, char **)
+{
+    entity_manager_t entity_manager = {};
+    signature_t signature = component_signature<position_t>();
+
+    entity_t first = create_entity(&entity_manager, signature);
+    entity_t entity = first;
+    int reuses = 0;
+    bool stale_rejected = true;
+    while(entity_index(entity) == entity_index(first))
+    {
+        destroy_entity(&entity_manager, entity);
+        stale_rejected = stale_rejected && entity_alive(&entity_manager, entity) == false;
+
+        entity = create_entity(&entity_manager, signature);
+        stale_rejected = stale_rejected && entity_alive(&entity_manager, first) == false;
+        if(entity_index(entity) == entity_index(first)) reuses++;
+    }
+    bool retired = reuses == static_cast<int>(ENTITY_GENERATION_MAX) - 1 && entity_manager.retired == 1;
+
+    printf("slot reused %d times, then %s\n", reuses, retired ? "retired" : "NOT RETIRED");
+    printf("stale handles: %s\n", stale_rejected ? "rejected" : "ACCEPTED");
+
+    while(static_cast<int>(entity_manager.generations.size()) < ENTITY_MAX_SLOTS)
+    {
+        if(create_entity(&entity_manager, signature) == NULL_ENTITY) break;
+    }
+    entity_t past = create_entity(&entity_manager, signature);
+    bool exhausted = static_cast<int>(entity_manager.generations.size()) == ENTITY_MAX_SLOTS && past == NULL_ENTITY &&
+        entity_manager.alive == ENTITY_MAX_SLOTS - 1;
+    bool null_dead = entity_alive(&entity_manager, NULL_ENTITY) == false && get_position(&entity_manager, NULL_ENTITY) == nullptr;
+
+    printf("slots: %d alive, %d retired, creating past them %s\n", entity_manager.alive, entity_manager.retired,
+        exhausted ? "fails" : "DID NOT FAIL");
+    printf("null entity: %s\n", null_dead ? "never alive" : "ALIVE");
+
+    return retired && stale_rejected && exhausted && null_dead ? 0 : 1;
+}
+
+// scripted players for a range of matches, scheduled as the first system of each tick
+typedef struct
+{
+    batch_tick_t* tick;
+    simulation_inputs_t* inputs;
+    unsigned int* player_random;
+} headless_players_t;
+
+void headless_player_job(void* context, int begin, int end)
+{
+    headless_players_t* players = static_cast<headless_players_t*>(context);
+    for (int match = begin; match < end; match++)
+    {
+        players->inputs[match] = headless_batch_inputs(players->tick->batch, match, &players->player_random[match]);
+    }
+}
+
+// Plays ticks of the batch with the players and batch systems on a scheduler of thread_count threads.
+// thread_count 0 steps it with batch_step on this thread instead, as the reference.
+double headless_threaded_batch(match_batch_t* batch, int matches, int ticks, int thread_count, int grain, long long* steals)
+{
+    simulation_clock_t simulation_clock;
+    simulation_clock_init(&simulation_clock, DEFAULT_TICK_RATE);
+
+    simulation_inputs_t* inputs = new simulation_inputs_t[matches];
+    unsigned int* player_random = new unsigned int[matches];
+    for (int match = 0; match < matches; match++)
+    {
+        player_random[match] = match;
+    }
+
+    batch_tick_t tick = {batch, inputs, static_cast<float>(simulation_clock.tick_dt)};
+    headless_players_t players = {&tick, inputs, player_random};
+
+    double seconds = 0.0;
+    if(thread_count == 0)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++)
+        {
+            headless_player_job(&players, 0, matches);
+            batch_step(batch, inputs, static_cast<float>(simulation_clock.tick_dt));
+        }
+        seconds = headless_seconds(start);
+    }
+    else
+    {
+        scheduler_t scheduler;
+        scheduler_init(&scheduler, thread_count);
+        scheduler_add_system(&scheduler, {"players", headless_player_job, &players,
+            BATCH_POSITIONS | BATCH_MATCHES, BATCH_INPUTS, matches, grain, true});
+        batch_schedule(&scheduler, &tick, grain);
+        scheduler_build(&scheduler);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++)
+        {
+            scheduler_run(&scheduler);
+        }
+        seconds = headless_seconds(start);
+
+        *steals = scheduler.steals;
+        scheduler_destroy(&scheduler);
+    }
+
+    delete[] player_random;
+    delete[] inputs;
+    return seconds;
+}
+
+// pong_headless threads [matches] [ticks] [max_threads] [grain]
+// Steps the same batch on 1, 2, 4, ... max_threads threads, printing the speedup over one thread and
+// checking every run ends in exactly the state the serial batch_step does.
+int headless_threads(int argc, char **argv)
+{
+    int matches = argc > 0 ? atoi(argv[0]) : 100000;
+    int ticks = argc > 1 ? atoi(argv[1]) : 1000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : 32;
+    int grain = argc > 3 ? atoi(argv[3]) : 1024;
+
+    if(matches <= 0 || ticks <= 0 || max_threads <= 0 || grain <= 0) return -1;
+
+    match_batch_t reference;
+    batch_init(&reference, matches, 1);
+    long long steals = 0;
+    double serial_seconds = headless_threaded_batch(&reference, matches, ticks, 0, grain, &steals);
+
+    printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    printf("serial: %.0f match ticks/s\n", static_cast<double>(matches) * ticks / serial_seconds);
+
+    bool identical = true;
+    double one_thread_seconds = 0.0;
+    for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        match_batch_t batch;
+        batch_init(&batch, matches, 1);
+        double seconds = headless_threaded_batch(&batch, matches, ticks, thread_count, grain, &steals);
+        if(thread_count == 1) one_thread_seconds = seconds;
+
+        bool same = headless_batch_equal(&batch, &reference) &&
+            memcmp(batch.left_scores, reference.left_scores, matches * sizeof(int)) == 0 &&
+            memcmp(batch.right_scores, reference.right_scores, matches * sizeof(int)) == 0 &&
+            memcmp(batch.matches, reference.matches, matches * sizeof(int)) == 0;
+        identical = identical && same;
+
+        printf("%2d threads: %12.0f match ticks/s  %5.2fx  %8lld steals  %s\n", thread_count,
+            static_cast<double>(matches) * ticks / seconds, one_thread_seconds / seconds, steals, same ? "ok" : "MISMATCH");
+        batch_destroy(&batch);
+    }
+
+    batch_destroy(&reference);
+    return identical ? 0 : 1;
+}
+
+// One frame's worth of drawing at scale times the game resolution: two paddles, the ball and two digit boxes.
+void headless_draw_frame(framebuffer_t* framebuffer, int scale, int frame)
+{
+    int y = (frame * scale) % (framebuffer->height - PADDLE_HEIGHT * scale);
+    framebuffer_fill_rect(framebuffer, {2 * scale, y, PADDLE_WIDTH * scale, PADDLE_HEIGHT * scale}, true);
+    framebuffer_fill_rect(framebuffer, {framebuffer->width - 3 * scale, framebuffer->height - PADDLE_HEIGHT * scale - y, PADDLE_WIDTH * scale, PADDLE_HEIGHT * scale}, true);
+    framebuffer_fill_rect(framebuffer, {(frame * scale) % framebuffer->width, y, scale, scale}, true);
+    framebuffer_fill_rect(framebuffer, {framebuffer->width / 2 - 7 * scale, framebuffer->height - 7 * scale, 3 * scale, 5 * scale}, true);
+    framebuffer_fill_rect(framebuffer, {framebuffer->width / 2 + 4 * scale, framebuffer->height - 7 * scale, 3 * scale, 5 * scale}, true);
+}
+
+bool headless_framebuffer_blank(framebuffer_t* framebuffer)
+{
+    for (int i = 0; i < framebuffer->stride * framebuffer->height; i++)
+    {
+        if(framebuffer->bits[i] != 0) return false;
+    }
+    return true;
+}
+
+// pong_headless clear [iterations]
+// Times clear + draw per frame for every clear mode from the game resolution up to 4K.
+int headless_clear(int argc, char **argv)
+{
+    int iterations = argc > 0 ? atoi(argv[0]) : 200;
+
+    if(iterations <= 0) return -1;
+
+    const int scales[] = {1, 5, 15, 30};
+    const framebuffer_clear_t modes[] = {CLEAR_NAIVE, CLEAR_MEMSET, CLEAR_STREAM, CLEAR_DIRTY};
+
+    bool blank = true;
+    for (int s = 0; s < 4; s++)
+    {
+        int scale = scales[s];
+        printf("%dx%d\n", PIXELS_WIDTH * scale, PIXELS_HEIGHT * scale);
+
+        for (int m = 0; m < 4; m++)
+        {
+            framebuffer_t framebuffer;
+            framebuffer_init(&framebuffer, PIXELS_WIDTH * scale, PIXELS_HEIGHT * scale);
+
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < iterations; frame++)
+            {
+                framebuffer_clear(&framebuffer, modes[m]);
+                headless_draw_frame(&framebuffer, scale, frame);
+            }
+            double seconds = headless_seconds(start);
+
+            framebuffer_clear(&framebuffer, modes[m]);
+            bool cleared = headless_framebuffer_blank(&framebuffer);
+            blank = blank && cleared;
+
+            printf("  %-7s %10.2f us/frame  %s\n", framebuffer_clear_name(modes[m]), seconds / iterations * 1e6, cleared ? "ok" : "NOT CLEARED");
+            framebuffer_destroy(&framebuffer);
+        }
+    }
+
+    return blank ? 0 : 1;
+}
+
+// pong_headless render [ticks]
+// Renders a played match every tick with a full clear, the dirty clear, the incremental renderer and
+// the layered one, checks all four frames are identical and reports time and pixels touched per frame.
+int headless_render(int argc, char **argv)
+{
+    int ticks = argc > 0 ? atoi(argv[0]) : 20000;
+
+    if(ticks <= 0) return -1;
+
+    simulation_state_t simulation;
+    simulation_init(&simulation, 1);
+    simulation_clock_t simulation_clock;
+    simulation_clock_init(&simulation_clock, DEFAULT_TICK_RATE);
+
+    framebuffer_t full, dirty, incremental, layered;
+    framebuffer_init(&full, PIXELS_WIDTH, PIXELS_HEIGHT);
+    framebuffer_init(&dirty, PIXELS_WIDTH, PIXELS_HEIGHT);
+    framebuffer_init(&incremental, PIXELS_WIDTH, PIXELS_HEIGHT);
+    framebuffer_init(&layered, PIXELS_WIDTH, PIXELS_HEIGHT);
+    renderer_background(&full);
+    renderer_background(&dirty);
+    renderer_background(&incremental);
+    render_cache_t cache = {};
+    render_layers_t layers;
+    render_layers_init(&layers, PIXELS_WIDTH, PIXELS_HEIGHT, NULL);
+
+    double seconds[4] = {};
+    long long touched[4] = {};
+    unsigned int player_random = 1;
+    bool identical = true;
+    for (int tick = 0; tick < ticks && identical; tick++)
+    {
+        simulation_step(&simulation, headless_inputs(&simulation, &player_random), static_cast<float>(simulation_clock.tick_dt));
+
+        auto start = std::chrono::steady_clock::now();
+        full.touched = 0;
+        renderer_system(&simulation, &full, CLEAR_MEMSET);
+        seconds[0] += headless_seconds(start);
+        touched[0] += full.touched;
+
+        start = std::chrono::steady_clock::now();
+        dirty.touched = 0;
+        renderer_system(&simulation, &dirty, CLEAR_DIRTY);
+        seconds[1] += headless_seconds(start);
+        touched[1] += dirty.touched;
+
+        start = std::chrono::steady_clock::now();
+        renderer_incremental(&simulation, &incremental, &cache);
+        seconds[2] += headless_seconds(start);
+        touched[2] += cache.pixels_touched;
+
+        start = std::chrono::steady_clock::now();
+        renderer_layered(&simulation, &layered, &layers);
+        seconds[3] += headless_seconds(start);
+        // the first frame composes everything, which would swamp the average
+        if(tick > 0) touched[3] += layers.pixels_touched;
+
+        int size = framebuffer_bytes(&full);
+        identical = memcmp(full.bits, dirty.bits, size) == 0 && memcmp(full.bits, incremental.bits, size) == 0 &&
+            memcmp(full.bits, layered.bits, size) == 0;
+        if(identical == false) fprintf(stderr, "frames differ at tick %d\n", tick);
+    }
+
+    const char* names[4] = {"full", "dirty", "incremental", "layered"};
+    for (int i = 0; i < 4; i++)
+    {
+        printf("%-12s %8.1f ns/frame  %8.1f pixels touched/frame\n", names[i], seconds[i] / ticks * 1e9, static_cast<double>(touched[i]) / ticks);
+    }
+    printf("frames: %s\n", identical ? "identical" : "DIFFER");
+
+    render_layers_destroy(&layers);
+    framebuffer_destroy(&layered);
+    framebuffer_destroy(&incremental);
+    framebuffer_destroy(&dirty);
+    framebuffer_destroy(&full);
+
+    return identical ? 0 : 1;
+}
+
+// pong_headless expand [iterations]
+// Expands random 1bpp frames to RGB and RGBA with every instruction set available, from the game
+// resolution up to 4K, and checks each path writes the same bytes as the scalar one.
+int headless_expand(int argc, char **argv)
+{
+    int iterations = argc > 0 ? atoi(argv[0]) : 200;
+
+    if(iterations <= 0) return -1;
+
+    const int scales[] = {1, 5, 15, 30};
+    simd_isa_t widest = simd_detect();
+
+    bool identical = true;
+    for (int s = 0; s < 4; s++)
+    {
+        framebuffer_t framebuffer;
+        framebuffer_init(&framebuffer, PIXELS_WIDTH * scales[s], PIXELS_HEIGHT * scales[s]);
+
+        unsigned int random = 7;
+        for (int i = 0; i < framebuffer.stride * framebuffer.height; i++)
+        {
+            framebuffer.bits[i] = static_cast<uint64_t>(simulation_random(&random)) << 49 ^
+                static_cast<uint64_t>(simulation_random(&random)) << 30 ^ simulation_random(&random);
+        }
+
+        int pixel_count = framebuffer.width * framebuffer.height;
+        printf("%dx%d: %d bytes packed, %d RGB\n", framebuffer.width, framebuffer.height, framebuffer_bytes(&framebuffer), pixel_count * 3);
+
+        for (int channels = 3; channels <= 4; channels++)
+        {
+            unsigned char* reference = new unsigned char[pixel_count * channels];
+            unsigned char* pixels = new unsigned char[pixel_count * channels];
+            framebuffer_expand_scalar(&framebuffer, reference, channels);
+
+            for (int isa = SIMD_SCALAR; isa <= widest; isa++)
+            {
+                memset(pixels, 0x55, pixel_count * channels);
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; i++)
+                {
+                    framebuffer_expand(static_cast<simd_isa_t>(isa), &framebuffer, pixels, channels);
+                }
+                double seconds = headless_seconds(start);
+
+                bool same = memcmp(pixels, reference, pixel_count * channels) == 0;
+                identical = identical && same;
+                printf("  %-4s %-6s %10.2f us/frame  %s\n", channels == 3 ? "rgb" : "rgba",
+                    simd_isa_name(static_cast<simd_isa_t>(isa)), seconds / iterations * 1e6, same ? "ok" : "MISMATCH");
+            }
+
+            delete[] pixels;
+            delete[] reference;
+        }
+
+        framebuffer_destroy(&framebuffer);
+    }
+
+    return identical ? 0 : 1;
+}
+
+// pong_headless upscale [iterations]
+// Scales a random frame and a rendered one up by whole factors, the 10x the window uses among them,
+// per pixel and with every instruction set available, and checks every path writes the same bytes.
+int headless_upscale(int argc, char **argv)
+{
+    int iterations = argc > 0 ? atoi(argv[0]) : 100;
+
+    if(iterations <= 0) return -1;
+
+    const int factors[] = {1, 2, 3, 7, 10};
+    simd_isa_t widest = simd_detect();
+
+    framebuffer_t frames[2];
+    framebuffer_init(&frames[0], PIXELS_WIDTH, PIXELS_HEIGHT);
+    unsigned int random = 7;
+    for (int i = 0; i < frames[0].stride * frames[0].height; i++)
+    {
+        frames[0].bits[i] = static_cast<uint64_t>(simulation_random(&random)) << 49 ^
+            static_cast<uint64_t>(simulation_random(&random)) << 30 ^ simulation_random(&random);
+    }
+
+    simulation_state_t simulation;
+    simulation_init(&simulation, 1);
+    framebuffer_init(&frames[1], PIXELS_WIDTH, PIXELS_HEIGHT);
+    renderer_system(&simulation, &frames[1], CLEAR_MEMSET);
+
+    arena_t scratch;
+    arena_init(&scratch, 4096);
+
+    bool identical = true;
+    for (int f = 0; f < 2; f++)
+    {
+        printf("%s frame\n", f == 0 ? "random" : "game");
+        for (int i = 0; i < 5; i++)
+        {
+            int factor = factors[i];
+            int pixel_count = PIXELS_WIDTH * factor * PIXELS_HEIGHT * factor;
+
+            for (int channels = 3; channels <= 4; channels++)
+            {
+                unsigned char* reference = new unsigned char[pixel_count * channels];
+                unsigned char* pixels = new unsigned char[pixel_count * channels];
+
+                auto start = std::chrono::steady_clock::now();
+                for (int it = 0; it < iterations; it++)
+                {
+                    framebuffer_upscale_naive(&frames[f], factor, reference, channels);
+                }
+                double naive = headless_seconds(start);
+                printf("  %2dx %-4s naive  %10.2f us/frame\n", factor, channels == 3 ? "rgb" : "rgba", naive / iterations * 1e6);
+
+                for (int isa = SIMD_SCALAR; isa <= widest; isa++)
+                {
+                    memset(pixels, 0x55, pixel_count * channels);
+                    start = std::chrono::steady_clock::now();
+                    for (int it = 0; it < iterations; it++)
+                    {
+                        framebuffer_upscale(static_cast<simd_isa_t>(isa), &frames[f], factor, pixels, channels, &scratch);
+                    }
+                    double seconds = headless_seconds(start);
+
+                    bool same = memcmp(pixels, reference, pixel_count * channels) == 0;
+                    identical = identical && same;
+                    printf("  %2dx %-4s %-6s %10.2f us/frame  %5.1fx  %s\n", factor, channels == 3 ? "rgb" : "rgba",
+                        simd_isa_name(static_cast<simd_isa_t>(isa)), seconds / iterations * 1e6, naive / seconds, same ? "ok" : "MISMATCH");
+                }
+
+                delete[] pixels;
+                delete[] reference;
+            }
+        }
+    }
+
+    arena_destroy(&scratch);
+    framebuffer_destroy(&frames[1]);
+    framebuffer_destroy(&frames[0]);
+
+    return identical ? 0 : 1;
+}
+
+// pong_headless clock [frames]
+// Feeds frames of exactly one tick period at a range of tick rates: every frame has to run exactly one
+// tick and leave nothing behind, or presentation falls a tick behind at matched rates.
+int headless_clock(int argc, char **argv)
+{
+    int frames = argc > 0 ? atoi(argv[0]) : 10000;
+
+    if(frames <= 0) return -1;
+
+    const int tick_rates[] = {30, 50, 60, 75, 120, 144, 240, 1000};
+    bool exact = true;
+    for (int i = 0; i < static_cast<int>(sizeof(tick_rates) / sizeof(tick_rates[0])); i++)
+    {
+        simulation_state_t simulation;
+        simulation_init(&simulation, 1);
+        simulation_clock_t clock;
+        simulation_clock_init(&clock, tick_rates[i]);
+        simulation_inputs_t inputs = {};
+
+        int uneven = 0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            int ticks = simulation_advance(&simulation, &clock, inputs, 1.0 / tick_rates[i]);
+            if(ticks != 1 || clock.alpha != 0.0f) uneven++;
+        }
+
+        bool matched = uneven == 0 && clock.ticks == frames;
+        exact = exact && matched;
+        printf("%5d Hz: %d frames, %lld ticks, %d frames off by a tick %s\n", tick_rates[i], frames, clock.ticks, uneven,
+            matched ? "ok" : "UNEVEN");
+    }
+
+    return exact ? 0 : 1;
+}
+
+// pong_headless loop [frames] [fps]
+// Runs the whole game loop, simulation, renderer and presenter, at a fixed frame rate with no window
+// and no GL, once per backend, and splits the frame time between the three. The simulation has to end
+// in the same state whichever backend presents it, and after the first second no frame may allocate.
+int headless_loop(int argc, char **argv)
+{
+    int frames = argc > 0 ? atoi(argv[0]) : 20000;
+    int fps = argc > 1 ? atoi(argv[1]) : 60;
+
+    if(frames <= 0 || fps <= 0) return -1;
+
+    unsigned int checksums[2] = {};
+    long long allocations[2] = {};
+    for (int backend = 0; backend < 2; backend++)
+    {
+        presenter_t presenter;
+        if(backend == 0) presenter_null_init(&presenter);
+        else presenter_offscreen_init(&presenter, PIXELS_WIDTH, PIXELS_HEIGHT, 4, PRESENTER_SCALE);
+
+        game_t game;
+        headless_game_init(&game);
+
+        unsigned int player_random = 1;
+        long long steady = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            if(frame == fps) steady = headless_allocations;
+            game_frame(&game, &presenter, headless_inputs(&game.simulation, &player_random), 1.0 / fps);
+        }
+        double seconds = headless_seconds(start);
+        checksums[backend] = headless_checksum(&game.simulation);
+        allocations[backend] = frames > fps ? headless_allocations - steady : 0;
+
+        printf("%-10s simulation %7.2f us  render %7.2f us  present %7.2f us  total %7.2f us/frame  matches %d\n",
+            presenter.name, game.simulation_seconds / frames * 1e6, game.render_seconds / frames * 1e6,
+            presenter.present_seconds / frames * 1e6, seconds / frames * 1e6, game.simulation.matches);
+        printf("%-10s allocations after the first second: %lld, arenas peak %zu + %zu bytes\n", presenter.name,
+            allocations[backend], game.persistent.peak, game.frame.peak);
+
+        if(backend == 1)
+        {
+            const offscreen_target_t* target = presenter_offscreen_target(&presenter);
+            unsigned int hash = 2166136261u;
+            int size = target->width * target->scale * target->height * target->scale * target->channels;
+            for (int i = 0; i < size; i++)
+            {
+                hash = (hash ^ target->pixels[i]) * 16777619u;
+            }
+            printf("last frame: %08x\n", hash);
+        }
+
+        game_destroy(&game);
+        presenter_destroy(&presenter);
+    }
+
+    bool same = checksums[0] == checksums[1];
+    printf("checksum: %08x %s\n", checksums[0], same ? "same on every backend" : "DIFFERS between backends");
+
+    return same && allocations[0] == 0 && allocations[1] == 0 ? 0 : 1;
+}
+
+// pong_headless profile [frames] [trace.json]
+// Runs the game loop with the offscreen presenter under the profiler, prints what every zone costs
+// per frame and writes the last events out as a Chrome trace. After the first second nothing may
+// allocate, recording included.
+int headless_profile(int argc, char **argv)
+{
+    int frames = argc > 0 ? atoi(argv[0]) : 600;
+    const char* path = argc > 1 ? argv[1] : "pong_trace.json";
+
+    if(frames <= 0) return -1;
+
+    profiler_init(true);
+    presenter_t presenter;
+    presenter_offscreen_init(&presenter, PIXELS_WIDTH, PIXELS_HEIGHT, 4, PRESENTER_SCALE);
+    game_t game;
+    headless_game_init(&game);
+
+    unsigned int player_random = 1;
+    long long steady = 0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        if(frame == 60) steady = headless_allocations;
+        profiler_frame_begin();
+        game_frame(&game, &presenter, headless_inputs(&game.simulation, &player_random), 1.0 / 60);
+        profiler_frame_end();
+    }
+    long long allocations = frames > 60 ? headless_allocations - steady : 0;
+
+    profiler_print(stdout);
+    printf("allocations after the first second: %lld\n", allocations);
+
+    bool written = profiler_write_trace(path);
+    if(written) printf("trace: %s\n", path);
+    else fprintf(stderr, "can't write %s\n", path);
+
+    game_destroy(&game);
+    presenter_destroy(&presenter);
+    profiler_destroy();
+
+    return written && allocations == 0 ? 0 : 1;
+}
+
+void headless_tapper(input_ring_t* ring, int taps, std::atomic<bool>* done)
+{
+    for (int tap = 0; tap < taps; tap++)
+    {
+        input_key_t key = tap == 0 ? INPUT_ENTER : static_cast<input_key_t>(INPUT_LEFT_PADDLE_UP + tap % 4);
+        input_event_t press = {key, true, input_time()};
+        while(input_ring_push(ring, press) == false) std::this_thread::yield();
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        input_event_t release = {key, false, input_time()};
+        while(input_ring_push(ring, release) == false) std::this_thread::yield();
+
+        std::this_thread::sleep_for(std::chrono::microseconds(2000));
+    }
+    done->store(true);
+}
+
+// pong_headless input [taps]
+// A second thread taps keys for a tenth of a millisecond each, far shorter than a tick, through the
+// event ring while the game loop runs on this one. Every tap has to reach a tick.
+int headless_input(int argc, char **argv)
+{
+    int taps = argc > 0 ? atoi(argv[0]) : 500;
+
+    if(taps <= 0) return -1;
+
+    presenter_t presenter;
+    presenter_null_init(&presenter);
+    game_t game;
+    headless_game_init(&game);
+
+    input_ring_t ring;
+    input_ring_init(&ring);
+    input_reader_t reader;
+    input_reader_init(&reader, &ring);
+
+    std::atomic<bool> done(false);
+    std::thread tapper(headless_tapper, &ring, taps, &done);
+
+    input_event_t pending;
+    auto last = std::chrono::steady_clock::now();
+    while(done.load() == false || input_ring_peek(&ring, &pending))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(4));
+        double frame_time = headless_seconds(last);
+        last = std::chrono::steady_clock::now();
+        game_frame_events(&game, &presenter, &reader, frame_time);
+    }
+    tapper.join();
+
+    long long presses = 0;
+    for (int key = 0; key < INPUT_KEYS; key++)
+    {
+        presses += reader.presses[key];
+    }
+
+    bool complete = presses == taps && reader.events == 2ll * taps && ring.dropped.load() == 0;
+    printf("taps: %d, presses reaching a tick: %lld, events: %lld, dropped: %lld\n", taps, presses, reader.events, ring.dropped.load());
+    input_reader_print(&reader, stdout);
+    printf("frames: %lld, ticks: %lld, game state %d\n", game.frames, game.clock.ticks, game.simulation.game_state);
+    printf("input: %s\n", complete ? "complete" : "LOST");
+
+    game_destroy(&game);
+    presenter_destroy(&presenter);
+
+    return complete ? 0 : 1;
+}
+
+// Stands in for the window system: key events wait in pending until the game polls.
+typedef struct
+{
+    std::mutex mutex;
+    std::vector<input_event_t> pending;
+    input_ring_t* ring;
+} headless_platform_t;
+
+void headless_poll(headless_platform_t* platform)
+{
+    std::lock_guard<std::mutex> lock(platform->mutex);
+    for (int i = 0; i < static_cast<int>(platform->pending.size()); i++)
+    {
+        input_ring_push(platform->ring, platform->pending[i]);
+    }
+    platform->pending.clear();
+}
+
+bool headless_pending(headless_platform_t* platform)
+{
+    std::lock_guard<std::mutex> lock(platform->mutex);
+    return platform->pending.empty() == false;
+}
+
+void headless_key(headless_platform_t* platform, input_key_t key, bool pressed)
+{
+    std::lock_guard<std::mutex> lock(platform->mutex);
+    platform->pending.push_back({key, pressed, input_time()});
+}
+
+// holds paddle keys for 20 to 80 ms with 10 to 40 ms between them
+void headless_paddle_player(headless_platform_t* platform, int presses, std::atomic<bool>* done)
+{
+    unsigned int random = 3;
+    headless_key(platform, INPUT_ENTER, true);
+    headless_key(platform, INPUT_ENTER, false);
+    for (int press = 0; press < presses; press++)
+    {
+        input_key_t key = press % 2 == 0 ? INPUT_LEFT_PADDLE_UP : INPUT_LEFT_PADDLE_DOWN;
+        headless_key(platform, key, true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20 + simulation_random(&random) % 60));
+        headless_key(platform, key, false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10 + simulation_random(&random) % 30));
+    }
+    done->store(true);
+}
+
+// Latching with the same keys the last tick had must draw the paddles exactly where interpolation
+// does, level with the ball, at every alpha.
+bool headless_latch_level(int frames)
+{
+    game_t game;
+    headless_game_init(&game);
+
+    unsigned int player_random = 1;
+    simulation_inputs_t ticked = {};
+    bool level = true;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        simulation_inputs_t inputs = headless_inputs(&game.simulation, &player_random);
+        long long ticks = game.clock.ticks;
+        game_simulate(&game, inputs, 1.0 / 144);
+        if(game.clock.ticks != ticks) ticked = inputs;
+
+        entity_manager_t* entity_manager = &game.simulation.entity_manager;
+        int left = get_position(entity_manager, game.simulation.left_paddle)->pixel_y;
+        int right = get_position(entity_manager, game.simulation.right_paddle)->pixel_y;
+        simulation_latch_paddles(&game.simulation, &game.latch, ticked, &game.clock);
+        level = level && get_position(entity_manager, game.simulation.left_paddle)->pixel_y == left &&
+            get_position(entity_manager, game.simulation.right_paddle)->pixel_y == right;
+    }
+
+    game_destroy(&game);
+    return level;
+}
+
+static int headless_direction(simulation_inputs_t inputs, int side)
+{
+    if(side == 0) return (inputs.left_paddle_up ? 1 : 0) - (inputs.left_paddle_down ? 1 : 0);
+    return (inputs.right_paddle_up ? 1 : 0) - (inputs.right_paddle_down ? 1 : 0);
+}
+
+static void headless_set_direction(simulation_inputs_t* inputs, int side, int direction)
+{
+    if(side == 0)
+    {
+        inputs->left_paddle_up = direction > 0;
+        inputs->left_paddle_down = direction < 0;
+    }
+    else
+    {
+        inputs->right_paddle_up = direction > 0;
+        inputs->right_paddle_down = direction < 0;
+    }
+}
+
+// Presses, releases and reversals, each held for 1 to 12 frames at 144 Hz, latched as soon as they
+// change. The drawn paddle row may never move against the held key from one frame to the next, and
+// while a key waits for its tick the latch may not move it past the row that tick then puts the paddle
+// on. Returns the frames that broke either rule.
+int headless_latch_keys(int frames)
+{
+    game_t game;
+    headless_game_init(&game);
+
+    unsigned int key_random = 7;
+    simulation_inputs_t keys = {};
+    keys.enter = 1;
+    int hold[2] = {};
+    int rows[2] = {};
+    int pending[2] = {};   // direction drawn ahead of its tick, 0 for none
+    int before[2] = {};    // the row drawn when it was pressed
+    int farthest[2] = {};  // the row drawn farthest along it since
+    int broken = 0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        long long ticks = game.clock.ticks;
+        int matches = game.simulation.matches;
+        game_simulate(&game, keys, 1.0 / 144);
+
+        entity_manager_t* entity_manager = &game.simulation.entity_manager;
+        entity_t paddles[2] = {game.simulation.left_paddle, game.simulation.right_paddle};
+        for (int side = 0; side < 2; side++)
+        {
+            if(game.clock.ticks == ticks || pending[side] == 0) continue;
+
+            // the keys drawn ahead were this frame's, and a tick has now consumed them
+            int consumed = static_cast<int>(get_position(entity_manager, paddles[side])->y);
+            bool moved = farthest[side] != before[side];
+            if(game.simulation.matches == matches && moved && (farthest[side] - consumed) * pending[side] > 0) broken++;
+            pending[side] = 0;
+        }
+
+        for (int side = 0; side < 2; side++)
+        {
+            if(--hold[side] > 0) continue;
+            hold[side] = 1 + simulation_random(&key_random) % 12;
+            headless_set_direction(&keys, side, static_cast<int>(simulation_random(&key_random) % 3) - 1);
+        }
+
+        simulation_latch_paddles(&game.simulation, &game.latch, keys, &game.clock);
+
+        for (int side = 0; side < 2; side++)
+        {
+            int row = get_position(entity_manager, paddles[side])->pixel_y;
+            int direction = headless_direction(keys, side);
+            bool visible = get_renderer(entity_manager, paddles[side])->visible;
+            if(frame > 0 && visible && game.simulation.matches == matches && (row - rows[side]) * direction < 0) broken++;
+
+            int ahead = direction != get_movement(entity_manager, paddles[side])->dir_y ? direction : 0;
+            if(ahead != pending[side]) before[side] = farthest[side] = rows[side];
+            pending[side] = ahead;
+            if((row - farthest[side]) * direction > 0) farthest[side] = row;
+            rows[side] = row;
+        }
+    }
+
+    game_destroy(&game);
+    return broken;
+}
+
+// pong_headless latch [presses] [work_ms]
+// Plays paddle presses into a 60 Hz loop whose swap blocks until the next refresh, with work_ms of
+// simulation and rendering work per frame, polling after the swap as the loop used to, before
+// simulating, and before simulating plus once more before drawing with late latching. Reports how
+// long each press takes to reach a presented frame. Then checks the latch with unchanged and changing keys.
+int headless_latch(int argc, char **argv)
+{
+    int presses = argc > 0 ? atoi(argv[0]) : 40;
+    double work = (argc > 1 ? atof(argv[1]) : 6.0) * 1e-3;
+
+    if(presses <= 0 || work < 0.0) return -1;
+
+    const double refresh = 1.0 / 60.0;
+    const char* names[3] = {"poll after swap", "poll first", "late latch"};
+    long long medians[3] = {};
+    bool complete = true;
+    for (int order = 0; order < 3; order++)
+    {
+        presenter_t presenter;
+        presenter_null_init(&presenter);
+        game_t game;
+        headless_game_init(&game);
+
+        input_ring_t ring;
+        input_ring_init(&ring);
+        input_reader_t* reader = new input_reader_t;
+        input_reader_init(reader, &ring);
+
+        headless_platform_t platform;
+        platform.ring = &ring;
+        std::atomic<bool> done(false);
+        std::thread player(headless_paddle_player, &platform, presses, &done);
+
+        auto start = std::chrono::steady_clock::now();
+        auto last = start;
+        input_event_t queued;
+        for (long long frame = 1; done.load() == false || input_ring_peek(&ring, &queued) || headless_pending(&platform); frame++)
+        {
+            if(order > 0) headless_poll(&platform);
+
+            double frame_time = headless_seconds(last);
+            last = std::chrono::steady_clock::now();
+            game_simulate_events(&game, reader, frame_time);
+
+            auto busy = std::chrono::steady_clock::now();
+            while(headless_seconds(busy) < work) {}
+
+            if(order == 2)
+            {
+                headless_poll(&platform);
+                game_latch(&game, reader);
+            }
+            game_present(&game, &presenter, reader);
+
+            std::this_thread::sleep_until(start + std::chrono::duration<double>(frame * refresh));
+            if(order == 0) headless_poll(&platform);
+        }
+        player.join();
+
+        medians[order] = latency_percentile(&reader->to_present, 0.5);
+        complete = complete && reader->to_present.total == 2ll * presses + 2;
+        latency_print(&reader->to_present, names[order], stdout);
+
+        delete reader;
+        game_destroy(&game);
+        presenter_destroy(&presenter);
+    }
+
+    printf("median gain over polling after the swap: poll first %.2f ms, late latch %.2f ms\n",
+        (medians[0] - medians[1]) * 1e-6, (medians[0] - medians[2]) * 1e-6);
+
+    bool level = headless_latch_level(5000);
+    printf("latched paddles with unchanged keys: %s\n", level ? "level with the ball" : "DRAWN AHEAD");
+    int broken = headless_latch_keys(20000);
+    printf("latched paddles with changing keys: %d frames moved against the key or past its tick\n", broken);
+
+    return complete && level && broken == 0 ? 0 : 1;
+}
+
+// pong_headless pace [fps] [seconds]
+// Runs the game loop uncapped, capped by sleeping alone and capped by sleeping then spinning the last
+// 2 ms, and reports frame time jitter and CPU use for each. Vsync needs a display, so it is not here.
+int headless_pace(int argc, char **argv)
+{
+    int fps = argc > 0 ? atoi(argv[0]) : 60;
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+
+    if(fps <= 0 || seconds <= 0.0) return -1;
+
+    const pace_mode_t modes[3] = {PACE_UNCAPPED, PACE_CAPPED, PACE_CAPPED};
+    const double spins[3] = {0.0, 0.0, 0.002};
+    for (int run = 0; run < 3; run++)
+    {
+        presenter_t presenter;
+        presenter_null_init(&presenter);
+        game_t game;
+        headless_game_init(&game);
+
+        frame_pacer_t pacer;
+        frame_pacer_init(&pacer, modes[run], fps, spins[run]);
+
+        unsigned int player_random = 1;
+        auto start = std::chrono::steady_clock::now();
+        auto last = start;
+        while(headless_seconds(start) < seconds)
+        {
+            frame_pacer_wait(&pacer);
+            double frame_time = headless_seconds(last);
+            last = std::chrono::steady_clock::now();
+            game_frame(&game, &presenter, headless_inputs(&game.simulation, &player_random), frame_time);
+        }
+
+        printf("spin %.1f ms, ", spins[run] * 1e3);
+        frame_pacer_print(&pacer, stdout);
+
+        game_destroy(&game);
+        presenter_destroy(&presenter);
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char* mode = argc > 1 ? argv[1] : "run";
+    int result = -1;
+
+    if(strcmp(mode, "run") == 0) result = headless_run(argc - 2, argv + 2);
+    else if(strcmp(mode, "batch") == 0) result = headless_batch(argc - 2, argv + 2);
+    else if(strcmp(mode, "verify") == 0) result = headless_verify(argc - 2, argv + 2);
+    else if(strcmp(mode, "kernels") == 0) result = headless_kernels(argc - 2, argv + 2);
+    else if(strcmp(mode, "entities") == 0) result = headless_entities(argc - 2, argv + 2);
+    else if(strcmp(mode, "handles") == 0) result = headless_handles(argc - 2, argv + 2);
+    else if(strcmp(mode, "threads") == 0) result = headless_threads(argc - 2, argv + 2);
+    else if(strcmp(mode, "clear") == 0) result = headless_clear(argc - 2, argv + 2);
+    else if(strcmp(mode, "render") == 0) result = headless_render(argc - 2, argv + 2);
+    else if(strcmp(mode, "expand") == 0) result = headless_expand(argc - 2, argv + 2);
+    else if(strcmp(mode, "upscale") == 0) result = headless_upscale(argc - 2, argv + 2);
+    else if(strcmp(mode, "input") == 0) result = headless_input(argc - 2, argv + 2);
+    else if(strcmp(mode, "latch") == 0) result = headless_latch(argc - 2, argv + 2);
+    else if(strcmp(mode, "pace") == 0) result = headless_pace(argc - 2, argv + 2);
+    else if(strcmp(mode, "clock") == 0) result = headless_clock(argc - 2, argv + 2);
+    else if(strcmp(mode, "loop") == 0) result = headless_loop(argc - 2, argv + 2);
+    else if(strcmp(mode, "profile") == 0) result = headless_profile(argc - 2, argv + 2);
+
+    if(result == -1)
+    {
+        fprintf(stderr, "usage: %s run [matches] [seed] [tick_rate]\n", argv[0]);
+        fprintf(stderr, "       %s batch [matches] [ticks] [seed]\n", argv[0]);
+        fprintf(stderr, "       %s verify [matches] [ticks] [seed]\n", argv[0]);
+        fprintf(stderr, "       %s kernels [matches] [iterations]\n", argv[0]);
+        fprintf(stderr, "       %s entities [count] [ticks]\n", argv[0]);
+        fprintf(stderr, "       %s handles\n", argv[0]);
+        fprintf(stderr, "       %s threads [matches] [ticks] [max_threads] [grain]\n", argv[0]);
+        fprintf(stderr, "       %s clear [iterations]\n", argv[0]);
+        fprintf(stderr, "       %s render [ticks]\n", argv[0]);
+        fprintf(stderr, "       %s expand [iterations]\n", argv[0]);
+        fprintf(stderr, "       %s upscale [iterations]\n", argv[0]);
+        fprintf(stderr, "       %s clock [frames]\n", argv[0]);
+        fprintf(stderr, "       %s loop [frames] [fps]\n", argv[0]);
+        fprintf(stderr, "       %s profile [frames] [trace.json]\n", argv[0]);
+        fprintf(stderr, "       %s input [taps]\n", argv[0]);
+        fprintf(stderr, "       %s latch [presses] [work_ms]\n", argv[0]);
+        fprintf(stderr, "       %s pace [fps] [seconds]\n", argv[0]);
+    }
+
+    return result;
+}
@@ -0,0 +1,146 @@
+#include <chrono>
+
+#include "input.h"
+
+void input_ring_init(input_ring_t* ring)
+{
+    ring->head.store(0);
+    ring->tail.store(0);
+    ring->dropped.store(0);
+}
+
+bool input_ring_push(input_ring_t* ring, input_event_t event)
+{
+    unsigned int tail = ring->tail.load(std::memory_order_relaxed);
+    if(tail - ring->head.load(std::memory_order_acquire) == static_cast<unsigned int>(INPUT_RING_SIZE))
+    {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ring->events[tail % INPUT_RING_SIZE] = event;
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool input_ring_peek(input_ring_t* ring, input_event_t* event)
+{
+    return input_ring_peek_at(ring, 0, event);
+}
+
+bool input_ring_peek_at(input_ring_t* ring, int offset, input_event_t* event)
+{
+    unsigned int head = ring->head.load(std::memory_order_relaxed);
+    if(ring->tail.load(std::memory_order_acquire) - head <= static_cast<unsigned int>(offset)) return false;
+
+    *event = ring->events[(head + offset) % INPUT_RING_SIZE];
+    return true;
+}
+
+void input_ring_pop(input_ring_t* ring)
+{
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+long long input_time()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void input_reader_init(input_reader_t* reader, input_ring_t* ring)
+{
+    *reader = {};
+    reader->ring = ring;
+}
+
+static void input_reader_trace(input_reader_t* reader, long long event, long long tick)
+{
+    if(reader->trace_count < INPUT_TRACES_PER_FRAME) reader->traces[reader->trace_count++] = {event, tick};
+    else reader->untraced++;
+}
+
+static simulation_inputs_t input_reader_inputs(const bool held[INPUT_KEYS], const bool tapped[INPUT_KEYS])
+{
+    simulation_inputs_t inputs = {};
+    inputs.enter = tapped[INPUT_ENTER];
+    inputs.left_paddle_up = held[INPUT_LEFT_PADDLE_UP] || tapped[INPUT_LEFT_PADDLE_UP];
+    inputs.left_paddle_down = held[INPUT_LEFT_PADDLE_DOWN] || tapped[INPUT_LEFT_PADDLE_DOWN];
+    inputs.right_paddle_up = held[INPUT_RIGHT_PADDLE_UP] || tapped[INPUT_RIGHT_PADDLE_UP];
+    inputs.right_paddle_down = held[INPUT_RIGHT_PADDLE_DOWN] || tapped[INPUT_RIGHT_PADDLE_DOWN];
+    return inputs;
+}
+
+simulation_inputs_t input_reader_tick(void* context, double tick_end)
+{
+    input_reader_t* reader = static_cast<input_reader_t*>(context);
+    long long tick_time = reader->frame_end + static_cast<long long>(tick_end * 1e9);
+
+    input_event_t event;
+    while(input_ring_peek(reader->ring, &event) && event.time <= tick_time)
+    {
+        input_ring_pop(reader->ring);
+
+        reader->held[event.key] = event.pressed;
+        if(event.pressed)
+        {
+            reader->tapped[event.key] = true;
+            reader->presses[event.key]++;
+        }
+
+        latency_record(&reader->to_tick, tick_time - event.time);
+        if(event.time > reader->latched_until) input_reader_trace(reader, event.time, tick_time);
+        reader->events++;
+    }
+
+    simulation_inputs_t inputs = input_reader_inputs(reader->held, reader->tapped);
+
+    for (int key = 0; key < INPUT_KEYS; key++)
+    {
+        reader->tapped[key] = false;
+    }
+    return inputs;
+}
+
+simulation_inputs_t input_reader_latch(input_reader_t* reader, long long now)
+{
+    bool held[INPUT_KEYS];
+    bool tapped[INPUT_KEYS];
+    for (int key = 0; key < INPUT_KEYS; key++)
+    {
+        held[key] = reader->held[key];
+        tapped[key] = reader->tapped[key];
+    }
+
+    input_event_t event;
+    for (int offset = 0; input_ring_peek_at(reader->ring, offset, &event) && event.time <= now; offset++)
+    {
+        held[event.key] = event.pressed;
+        if(event.pressed) tapped[event.key] = true;
+
+        if(event.time > reader->latched_until)
+        {
+            input_reader_trace(reader, event.time, now);
+            reader->latched_until = event.time;
+        }
+    }
+
+    return input_reader_inputs(held, tapped);
+}
+
+void input_reader_frame(input_reader_t* reader, long long rendered, long long presented)
+{
+    for (int i = 0; i < reader->trace_count; i++)
+    {
+        latency_record(&reader->to_render, rendered - reader->traces[i].event);
+        latency_record(&reader->to_present, presented - reader->traces[i].event);
+    }
+    reader->trace_count = 0;
+}
+
+void input_reader_print(const input_reader_t* reader, FILE* file)
+{
+    fprintf(file, "input latency over %lld events (%lld untraced)\n", reader->events, reader->untraced);
+    latency_print(&reader->to_tick, "event to tick", file);
+    latency_print(&reader->to_render, "event to render", file);
+    latency_print(&reader->to_present, "event to present", file);
+}
@@ -0,0 +1,98 @@
+#ifndef PONG_INPUT_H
+#define PONG_INPUT_H
+
+#include <atomic>
+
+#include "simulation.h"
+#include "latency.h"
+
+typedef enum
+{
+    INPUT_ENTER,
+    INPUT_LEFT_PADDLE_UP,
+    INPUT_LEFT_PADDLE_DOWN,
+    INPUT_RIGHT_PADDLE_UP,
+    INPUT_RIGHT_PADDLE_DOWN,
+    INPUT_KEYS
+} input_key_t;
+
+typedef struct
+{
+    input_key_t key;
+    bool pressed;
+    long long time; // input_time nanoseconds
+} input_event_t;
+
+// power of two
+const int INPUT_RING_SIZE = 256;
+
+// Lock-free queue from one producer, the thread polling the window, to one consumer, the simulation.
+// head and tail only grow; the slot is the low bits. A full ring refuses the event and counts it.
+typedef struct
+{
+    input_event_t events[INPUT_RING_SIZE];
+    alignas(64) std::atomic<unsigned int> head; // next to read, only the consumer writes it
+    alignas(64) std::atomic<unsigned int> tail; // next to write, only the producer writes it
+    std::atomic<long long> dropped;
+} input_ring_t;
+
+void input_ring_init(input_ring_t* ring);
+// producer side
+bool input_ring_push(input_ring_t* ring, input_event_t event);
+// consumer side: the oldest event without taking it, then taking it
+bool input_ring_peek(input_ring_t* ring, input_event_t* event);
+// the event offset places after the oldest, still without taking anything
+bool input_ring_peek_at(input_ring_t* ring, int offset, input_event_t* event);
+void input_ring_pop(input_ring_t* ring);
+
+// steady clock, nanoseconds
+long long input_time();
+
+// An event on its way to the screen, kept from the tick that consumed it until its frame is shown.
+typedef struct
+{
+    long long event;
+    long long tick; // end of the consuming tick
+} input_trace_t;
+
+// traces a frame holds; more events than that in one frame go untraced
+const int INPUT_TRACES_PER_FRAME = 64;
+
+// Turns the event stream into per tick inputs. Events are consumed at the first tick ending after
+// them; a key pressed during a tick counts for that tick even if it was released again before its
+// end, so short taps are never lost. Enter only counts on the tick it was pressed.
+typedef struct
+{
+    input_ring_t* ring;
+    long long frame_end; // input_time the frame being advanced ends at
+
+    bool held[INPUT_KEYS];
+    bool tapped[INPUT_KEYS];
+
+    long long events;
+    long long presses[INPUT_KEYS];
+
+    input_trace_t traces[INPUT_TRACES_PER_FRAME];
+    int trace_count;
+    long long untraced;
+    // newest event a late latch already put on screen, so its tick doesn't trace it twice
+    long long latched_until;
+
+    // from each event to the end of its tick, to its frame being rendered and to that frame's present
+    // returning, the swap for a window, which is as close to photons as the application can see
+    latency_histogram_t to_tick;
+    latency_histogram_t to_render;
+    latency_histogram_t to_present;
+} input_reader_t;
+
+void input_reader_init(input_reader_t* reader, input_ring_t* ring);
+// a simulation_input_source_t, context is the input_reader_t
+simulation_inputs_t input_reader_tick(void* context, double tick_end);
+// Keys as they are at now, including events no tick has consumed yet, which stay queued. Those
+// events are traced from here, as this frame is the first to show them.
+simulation_inputs_t input_reader_latch(input_reader_t* reader, long long now);
+// closes the traces of the frame just shown, rendered and presented at those input_time stamps
+void input_reader_frame(input_reader_t* reader, long long rendered, long long presented);
+void input_reader_print(const input_reader_t* reader, FILE* file);
+
+#endif
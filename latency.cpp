@@ -0,0 +1,53 @@
+#include "latency.h"
+
+static int latency_bucket(long long nanoseconds)
+{
+    if(nanoseconds < LATENCY_SUB_BUCKETS) return nanoseconds < 0 ? 0 : static_cast<int>(nanoseconds);
+
+    int exponent = 0;
+    while(nanoseconds >> (exponent + 1) != 0) exponent++;
+    int sub = static_cast<int>(nanoseconds >> (exponent - 4)) - LATENCY_SUB_BUCKETS;
+    int bucket = (exponent - 3) * LATENCY_SUB_BUCKETS + sub;
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+static long long latency_bucket_top(int bucket)
+{
+    if(bucket < LATENCY_SUB_BUCKETS) return bucket;
+
+    int exponent = bucket / LATENCY_SUB_BUCKETS + 3;
+    long long sub = bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS;
+    return ((sub + 1) << (exponent - 4)) - 1;
+}
+
+void latency_record(latency_histogram_t* histogram, long long nanoseconds)
+{
+    histogram->counts[latency_bucket(nanoseconds)]++;
+    histogram->total++;
+    if(nanoseconds > histogram->max) histogram->max = nanoseconds;
+}
+
+long long latency_percentile(const latency_histogram_t* histogram, double fraction)
+{
+    long long wanted = static_cast<long long>(fraction * histogram->total + 0.5);
+    if(wanted < 1) wanted = 1;
+
+    long long seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += histogram->counts[bucket];
+        if(seen >= wanted)
+        {
+            long long top = latency_bucket_top(bucket);
+            return top < histogram->max ? top : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void latency_print(const latency_histogram_t* histogram, const char* name, FILE* file)
+{
+    fprintf(file, "%-18s %8lld samples  p50 %8.3f ms  p99 %8.3f ms  p999 %8.3f ms  max %8.3f ms\n", name, histogram->total,
+        latency_percentile(histogram, 0.5) * 1e-6, latency_percentile(histogram, 0.99) * 1e-6,
+        latency_percentile(histogram, 0.999) * 1e-6, histogram->max * 1e-6);
+}
@@ -0,0 +1,24 @@
+#ifndef PONG_LATENCY_H
+#define PONG_LATENCY_H
+
+#include <stdio.h>
+
+// Log-linear buckets: exact below 16 ns, then 16 buckets per power of two, so any percentile is
+// within about 6% of the true value. Values past the last bucket land in it.
+const int LATENCY_SUB_BUCKETS = 16;
+const int LATENCY_BUCKETS = (40 - 3) * LATENCY_SUB_BUCKETS;
+
+typedef struct
+{
+    long long counts[LATENCY_BUCKETS];
+    long long total;
+    long long max;
+} latency_histogram_t;
+
+void latency_record(latency_histogram_t* histogram, long long nanoseconds);
+// smallest value at least fraction of the samples are at or below, as its bucket's upper bound
+long long latency_percentile(const latency_histogram_t* histogram, double fraction);
+// one line: samples, p50, p99, p999 and max in milliseconds
+void latency_print(const latency_histogram_t* histogram, const char* name, FILE* file);
+
+#endif
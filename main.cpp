@@ -1,163 +1,16 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <cmath>
-#include <GLFW/glfw3.h>
+
+#include "presenter_window.h"
+#include "game.h"
+#include "pacer.h"
+#include "profiler.h"
 
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 640;
 
-const unsigned int PIXELS_WIDTH = 128;
-const unsigned int PIXELS_HEIGHT = 64;
-
-const int PADDLE_WIDTH = 1;
-const int PADDLE_HEIGHT = 8;
-
-int numbers[][15] = {
-    {
-        1, 1, 1,
-        1, 0, 1,
-        1, 0, 1,
-        1, 0, 1,
-        1, 1, 1,
-    },
-    {
-        0, 0, 1,
-        0, 0, 1,
-        0, 0, 1,
-        0, 0, 1,
-        0, 0, 1,
-    },
-    {
-        1, 1, 1,
-        0, 0, 1,
-        1, 1, 1,
-        1, 0, 0,
-        1, 1, 1,
-    },
-    {
-        1, 1, 1,
-        0, 0, 1,
-        1, 1, 1,
-        0, 0, 1,
-        1, 1, 1,
-    },
-    {
-        1, 0, 1,
-        1, 0, 1,
-        1, 1, 1,
-        0, 0, 1,
-        0, 0, 1,
-    },
-    {
-        1, 1, 1,
-        1, 0, 0,
-        1, 1, 1,
-        0, 0, 1,
-        1, 1, 1,
-    },
-    {
-        1, 1, 1,
-        1, 0, 0,
-        1, 1, 1,
-        1, 0, 1,
-        1, 1, 1,
-    },
-    {
-        1, 1, 1,
-        0, 0, 1,
-        0, 0, 1,
-        0, 0, 1,
-        0, 0, 1,
-    },
-    {
-        1, 1, 1,
-        1, 0, 1,
-        1, 1, 1,
-        1, 0, 1,
-        1, 1, 1,
-    },
-    {
-        1, 1, 1,
-        1, 0, 1,
-        1, 1, 1,
-        0, 0, 1,
-        0, 0, 1,
-    }
-};
-
-typedef enum
-{
-    IDLE,
-    PREPARATION,
-    GAMEPLAY,
-    POINT
-} game_state_t;
-
-typedef enum {
-    EXTENSION,
-    POSITION,
-    MOVEMENT,
-    RENDERER
-} component_uid_t;
-
-typedef struct
-{
-    float x, y;
-    int w, h;
-    float speed;
-    bool visible;
-} entity_resource_t;
-
-typedef struct
-{
-    int w, h;
-} extension_t;
-
-typedef struct
-{
-    float x, y;
-    int pixel_x, pixel_y;
-} position_t;
-
-typedef struct
-{
-    float dir_x, dir_y;
-    float speed;
-} movement_t;
-
-typedef struct
-{
-    bool visible;
-} renderer_t;
-
-typedef struct
-{
-    unsigned int components[3];
-
-    extension_t extensions[3];
-    position_t position[3];
-    movement_t movements[3];
-    renderer_t renderers[3];
-
-    int length;
-} entity_manager_t;
-
-typedef struct
-{
-    int left_paddle_up;
-    int left_paddle_down;
-    int right_paddle_up;
-    int right_paddle_down;
-    int enter;
-} key_mapping_t;
-
-key_mapping_t key_mapping;
-
-int create_entity(entity_manager_t* entity_manager, unsigned int components);
-void setup_component(entity_manager_t* entity_manager, int entity, entity_resource_t resource);
-void movement_system(entity_manager_t* entity_manager);
-void renderer_system(entity_manager_t* entity_manager, GLubyte* pixels_buffer);
-void update_ball(entity_manager_t* entity_manager, int ball, int paddles[2]);
-void update_paddle(entity_manager_t* entity_manager, int paddle);
+input_ring_t input_ring;
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
@@ -171,7 +24,7 @@ int main(int argc, char **argv)
     }
 
     window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Pong", NULL, NULL);
-    if(window == false)
+    if(window == NULL)
     {
         glfwTerminate();
         return -1;
@@ -180,381 +33,114 @@ int main(int argc, char **argv)
     glfwSetKeyCallback(window, key_callback);
     glfwMakeContextCurrent(window);
 
-    GLubyte* pixels_buffer = new GLubyte[PIXELS_WIDTH * PIXELS_HEIGHT * 3];
-
-    entity_resource_t left_paddle_rsc = {2, 2, PADDLE_WIDTH, PADDLE_HEIGHT, 1, false};
-    entity_resource_t right_paddle_rsc = {PIXELS_WIDTH - 3, 15, PADDLE_WIDTH, PADDLE_HEIGHT, 1, false};
-    entity_resource_t ball_rsc = {PIXELS_WIDTH / 2, PIXELS_HEIGHT / 2, 1, 1, 1, true};
-
-    entity_manager_t entity_manager = {};
-    game_state_t game_state = IDLE;
-    int left_score = 0, right_score = 0;
-    int point = 0;
-    float seconds = 0;
-
-    int left_paddle = create_entity(&entity_manager, EXTENSION | POSITION | MOVEMENT);
-    setup_component(&entity_manager, left_paddle, left_paddle_rsc);
-
-    int right_paddle = create_entity(&entity_manager, EXTENSION | POSITION | MOVEMENT);
-    setup_component(&entity_manager, right_paddle, right_paddle_rsc);
-
-    int ball = create_entity(&entity_manager, EXTENSION | POSITION | MOVEMENT);
-    setup_component(&entity_manager, ball, ball_rsc);
-    entity_manager.movements[ball].dir_x = rand() % 2 == 0 ? 1 : -1;
-    entity_manager.movements[ball].dir_y = rand() % 2 == 0 ? 1 : -1;
-
-    float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
-    while(glfwWindowShouldClose(window) == false)
+    // pong [tick_rate] [vsync|capped|uncapped] [fps] [trace.json]
+    pace_mode_t pace_mode = PACE_VSYNC;
+    if(argc > 2 && frame_pacer_parse(argv[2], &pace_mode) == false)
     {
-        // time
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // game
-        {
-            entity_manager.movements[left_paddle].dir_y = 0;
-            if(key_mapping.left_paddle_up)
-            {
-                entity_manager.movements[left_paddle].dir_y += 1;
-            }
-            if(key_mapping.left_paddle_down)
-            {
-                entity_manager.movements[left_paddle].dir_y -= 1;
-            }
-
-            entity_manager.movements[right_paddle].dir_y = 0;
-            if(key_mapping.right_paddle_up)
-            {
-                entity_manager.movements[right_paddle].dir_y += 1;
-            }
-            if(key_mapping.right_paddle_down)
-            {
-                entity_manager.movements[right_paddle].dir_y -= 1;
-            }
-
-            movement_system(&entity_manager);
-
-            switch(game_state)
-            {
-                case IDLE:
-                {
-                    if(key_mapping.enter)
-                    {
-                        entity_manager.movements[ball].dir_x = rand() % 2 == 0 ? 1 : -1;
-                        entity_manager.movements[ball].dir_y = rand() % 2 == 0 ? 1 : -1;
-
-                        entity_manager.renderers[ball].visible = false;
-                        entity_manager.renderers[left_paddle].visible = true;
-                        entity_manager.renderers[right_paddle].visible = true;
-
-                        game_state = PREPARATION;
-                    }
-                    break;
-                }
-                case PREPARATION:
-                {
-                    seconds += deltaTime;
-                    if(seconds >= 2.0)
-                    {
-                        setup_component(&entity_manager, ball, ball_rsc);
-                        entity_manager.movements[ball].dir_y = rand() % 2 == 0 ? 1 : -1;
-
-                        seconds = 0.0;
-                        point = 0;
-                        game_state = GAMEPLAY;
-                    }
-                    break;
-                }
-                case GAMEPLAY:
-                {
-                    position_t ball_point = entity_manager.position[ball];
-                    extension_t ball_extension = entity_manager.extensions[ball];
-
-                    if(ball_point.x <= 0 || (ball_point.x + ball_extension.w - 1) >= PIXELS_WIDTH - 1)
-                    {
-                        if(ball_point.x <= 0)
-                        {
-                            point = -1;
-                            left_score++;
-                        } 
-                        else
-                        {
-                            point = 1;
-                            right_score++;
-                        }
-
-                        entity_manager.renderers[ball].visible = false;
-                        game_state = POINT;
-                    }
-                    break;
-                }
-                case POINT:
-                {
-                    game_state = PREPARATION;
-
-                    if(left_score >= 10 || right_score >= 10)
-                    {
-                        setup_component(&entity_manager, ball, ball_rsc);
-                        setup_component(&entity_manager, left_paddle, left_paddle_rsc);
-                        setup_component(&entity_manager, right_paddle, right_paddle_rsc);
-
-                        left_score = right_score = 0;
-
-                        game_state = IDLE;
-                    }
-                    break;
-                }
-            }
-
-            update_paddle(&entity_manager, left_paddle);
-            update_paddle(&entity_manager, right_paddle);
-
-            int entities[2] = {left_paddle, right_paddle};
-            update_ball(&entity_manager, ball, entities);
-
-            renderer_system(&entity_manager, pixels_buffer);
-
-            const int x_offset = 4;
-            const int y_offset = 2;
-            for (int i = 0; i < 15; i++)
-            {
-                int pixel = numbers[right_score][i];
-
-                if(pixel == 0) continue;
-
-                int index = ((((PIXELS_WIDTH / 2) - 3 - x_offset) + (i % 3)) + ((PIXELS_HEIGHT - 1) - (i / 3) - y_offset) * PIXELS_WIDTH) * 3;
-                pixels_buffer[index] = 255;
-                pixels_buffer[index + 1] = 255;
-                pixels_buffer[index + 2] = 255;
-            }
-            for (int i = 0; i < 15; i++)
-            {
-                int pixel = numbers[left_score][i];
-
-                if(pixel == 0) continue;
-
-                int index = (((PIXELS_WIDTH / 2) + (i % 3) + x_offset) + ((PIXELS_HEIGHT - 1) - (i / 3) - y_offset) * PIXELS_WIDTH) * 3;
-                pixels_buffer[index] = 255;
-                pixels_buffer[index + 1] = 255;
-                pixels_buffer[index + 2] = 255;
-            }
-        }
-
-        // render
-        glClear(GL_COLOR_BUFFER_BIT);
-        glPixelZoom(SCR_WIDTH / PIXELS_WIDTH, SCR_HEIGHT / PIXELS_HEIGHT);
-        glDrawPixels(PIXELS_WIDTH, PIXELS_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, pixels_buffer);
-
-        glLineStipple(10, 0xAAAA);
-        glEnable(GL_LINE_STIPPLE);
-        glLineWidth(3);
-        glBegin(GL_LINES);
-            glColor3f(1.0f, 1.0f, 1.0f);
-            glVertex2f(0.0f, -1.0f);
-            glVertex2f(0.0f, 1.0f);
-        glEnd();
-
-        glfwSwapBuffers(window);
-
-        glfwPollEvents();
+        fprintf(stderr, "usage: %s [tick_rate] [vsync|capped|uncapped] [fps] [trace.json]\n", argv[0]);
+        glfwTerminate();
+        return -1;
     }
 
-    glfwTerminate();
+    // adaptive vsync tears a late frame instead of holding it for the next refresh
+    bool adaptive = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+    glfwSwapInterval(pace_mode == PACE_VSYNC ? (adaptive ? -1 : 1) : 0);
 
-    return 0;
-}
+    frame_pacer_t pacer;
+    frame_pacer_init(&pacer, pace_mode, argc > 3 ? atoi(argv[3]) : 60, 0.002);
 
-int create_entity(entity_manager_t* entity_manager, unsigned int components)
-{
-    int entity = entity_manager->length++;
-    entity_manager->components[entity] = components;
-    return entity;
-}
-
-void setup_component(entity_manager_t* entity_manager, int entity, entity_resource_t resource)
-{
-    unsigned int components_mask = entity_manager->components[entity];
-
-    if((components_mask & EXTENSION) == EXTENSION)
-    {
-        entity_manager->extensions[entity].w = resource.w;
-        entity_manager->extensions[entity].h = resource.h;
-    }
+    presenter_t presenter;
+    presenter_window_init(&presenter, window, PIXELS_WIDTH, PIXELS_HEIGHT);
 
-    if((components_mask & POSITION) == POSITION)
+    game_t game;
+    if(game_init(&game, argc > 1 ? atoi(argv[1]) : DEFAULT_TICK_RATE, 1) == false)
     {
-        entity_manager->position[entity].x = resource.x;
-        entity_manager->position[entity].y = resource.y;
-    }
-
-    if((components_mask & MOVEMENT) == MOVEMENT)
-    {
-        entity_manager->movements[entity].speed = resource.speed;
-    }
-
-    if((components_mask & RENDERER) == RENDERER)
-    {
-        entity_manager->renderers[entity].visible = resource.visible;
+        fprintf(stderr, "the game doesn't fit in its arenas\n");
+        game_destroy(&game);
+        presenter_destroy(&presenter);
+        glfwTerminate();
+        return -1;
     }
-}
-
-void movement_system(entity_manager_t* entity_manager)
-{
-    const unsigned int REQUIRED_COMPONENTS = EXTENSION | POSITION | MOVEMENT;
-    for (int entity = 0; entity < entity_manager->length; entity++)
-    {
-        unsigned int components_mask = entity_manager->components[entity];
-
-        if((components_mask & REQUIRED_COMPONENTS) != REQUIRED_COMPONENTS) continue;
-
-        extension_t size = entity_manager->extensions[entity];
-        position_t position = entity_manager->position[entity];
-        movement_t movement = entity_manager->movements[entity];
 
-        //float m = sqrt(movement.dir_x * movement.dir_x + movement.dir_y * movement.dir_y);
-        //movement.dir_x /= m;
-        //movement.dir_y /= m;
+    input_ring_init(&input_ring);
+    input_reader_t input_reader;
+    input_reader_init(&input_reader, &input_ring);
 
-        position.x += movement.dir_x * movement.speed;
-        position.y += movement.dir_y * movement.speed;
-
-        position.pixel_x = static_cast <int> (position.x);
-        position.pixel_y = static_cast <int> (position.y);
-
-        entity_manager->position[entity] = position;
-    }
-}
+    profiler_init(true);
 
-void renderer_system(entity_manager_t* entity_manager, GLubyte* pixels_buffer)
-{
-    for (int x = 0; x < PIXELS_WIDTH; x++)
+    double deltaTime = 0.0;
+    double lastFrame = glfwGetTime();
+    while(glfwWindowShouldClose(window) == false)
     {
-        for (int y = 0; y < PIXELS_HEIGHT; y++)
-        {
-            int position = (x + y * PIXELS_WIDTH) * 3;
-            pixels_buffer[position] = 0;
-            pixels_buffer[position + 1] = 0;
-            pixels_buffer[position + 2] = 0;
-        }
-    }
+        // wait first, so input is read right before it is simulated, not left over from the wait
+        frame_pacer_wait(&pacer);
+        profiler_frame_begin();
+        glfwPollEvents();
 
-    const unsigned int REQUIRED_COMPONENTS = EXTENSION | POSITION | RENDERER;
-    for (int entity = 0; entity < entity_manager->length; entity++)
-    {
-        unsigned int components_mask = entity_manager->components[entity];
+        // time
+        double currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
 
-        if((components_mask & REQUIRED_COMPONENTS) != REQUIRED_COMPONENTS) continue;
+        game_simulate_events(&game, &input_reader, deltaTime);
 
-        renderer_t renderer = entity_manager->renderers[entity];
-        if(renderer.visible == false) continue;
+        // and once more for the paddles right before they are drawn
+        glfwPollEvents();
+        game_latch(&game, &input_reader);
 
-        extension_t size = entity_manager->extensions[entity];
-        position_t position = entity_manager->position[entity];
-        for (int w = 0; w < size.w; w++)
-        {
-            for (int h = 0; h < size.h; h++)
-            {
-                int i = ((position.pixel_x + w) + (position.pixel_y + h) * PIXELS_WIDTH) * 3;
-                pixels_buffer[i] = 255;
-                pixels_buffer[i + 1] = 255;
-                pixels_buffer[i + 2] = 255;
-            }
-        }
+        game_present(&game, &presenter, &input_reader);
+        profiler_frame_end();
     }
-}
-
-void update_ball(entity_manager_t* entity_manager, int ball, int paddles[2])
-{
-    if(entity_manager->renderers[ball].visible == false) return;
-
-    position_t ball_position = entity_manager->position[ball];
-    extension_t ball_extension = entity_manager->extensions[ball];
-    movement_t ball_movement = entity_manager->movements[ball];
 
-    if(ball_position.x <= 0 || (ball_position.x + ball_extension.w - 1) >= PIXELS_WIDTH - 1)
+    if(game.frames > 0)
     {
-        ball_position.x = ball_position.x <= 0 ? 0 : PIXELS_WIDTH - ball_extension.w;
-        ball_movement.dir_x *= -1;
+        printf("simulation: %.1f us/frame, render: %.1f us/frame, present: %.1f us/frame\n",
+            game.simulation_seconds / game.frames * 1e6, game.render_seconds / game.frames * 1e6,
+            presenter.present_seconds / game.frames * 1e6);
     }
-    if(ball_position.y <= 0 || (ball_position.y + ball_extension.h - 1) >= PIXELS_HEIGHT - 1)
-    {
-        ball_position.y = ball_position.y <= 0 ? 0 : PIXELS_HEIGHT - ball_extension.h;
-        ball_movement.dir_y *= -1;
-    }
-
-    for (int i = 0; i < 2; i++)
-    {
-        if(entity_manager->renderers[paddles[i]].visible == false) continue;
 
-        position_t paddle_point = entity_manager->position[paddles[i]];
-        extension_t paddle_extension = entity_manager->extensions[paddles[i]];
+    if(input_reader.events > 0) input_reader_print(&input_reader, stdout);
+    frame_pacer_print(&pacer, stdout);
+    profiler_print(stdout);
+    if(argc > 4 && profiler_write_trace(argv[4]) == false) fprintf(stderr, "can't write %s\n", argv[4]);
 
-        if(ball_position.x >= paddle_point.x && ball_position.x <= paddle_point.x + paddle_extension.w - 1)
-        {
-            if(ball_position.y >= paddle_point.y && ball_position.y <= paddle_point.y + paddle_extension.h - 1)
-            {
-                if(ball_movement.dir_x == -1)
-                {
-                    ball_position.x = paddle_point.x + paddle_extension.w;
-                } 
-                else if(ball_movement.dir_x == 1)
-                {
-                    ball_position.x = paddle_point.x - ball_extension.w;
-                }
-
-                ball_movement.dir_x *= -1;
-                //ball_movement.speed += 0.1f;
-            }
-        }
-    } 
-
-    entity_manager->position[ball] = ball_position;
-    entity_manager->movements[ball] = ball_movement;
-}
-
-void update_paddle(entity_manager_t* entity_manager, int paddle)
-{
-    if(entity_manager->renderers[paddle].visible == false) return;
-
-    position_t paddle_point = entity_manager->position[paddle];
-    extension_t paddle_extension = entity_manager->extensions[paddle];
-
-    if(paddle_point.y <= 0)
-    {
-        paddle_point.y = 0;
-    }
-    else if(paddle_point.y + paddle_extension.h - 1 >= PIXELS_HEIGHT - 1)
-    {
-        paddle_point.y = PIXELS_HEIGHT - paddle_extension.h;
-    }
+    presenter_destroy(&presenter);
+    game_destroy(&game);
+    profiler_destroy();
+    glfwTerminate();
 
-    entity_manager->position[paddle] = paddle_point;
+    return 0;
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    bool pressing = action == GLFW_PRESS || action == GLFW_REPEAT;
+    // repeats change nothing, the key is still held
+    if(action == GLFW_REPEAT) return;
+
+    input_event_t event;
+    event.pressed = action == GLFW_PRESS;
+    event.time = input_time();
 
     switch (key)
     {
         case GLFW_KEY_ENTER:
-        key_mapping.enter = action == GLFW_PRESS;
+        event.key = INPUT_ENTER;
             break;
         case GLFW_KEY_W:
-        key_mapping.left_paddle_up = pressing;
+        event.key = INPUT_LEFT_PADDLE_UP;
             break;
         case GLFW_KEY_S:
-        key_mapping.left_paddle_down = pressing;
+        event.key = INPUT_LEFT_PADDLE_DOWN;
             break;
         case GLFW_KEY_UP:
-        key_mapping.right_paddle_up = pressing;
+        event.key = INPUT_RIGHT_PADDLE_UP;
             break;
         case GLFW_KEY_DOWN:
-        key_mapping.right_paddle_down = pressing;
+        event.key = INPUT_RIGHT_PADDLE_DOWN;
             break;
         default:
-            break;
+            return;
     }
+
+    input_ring_push(&input_ring, event);
 }
@@ -0,0 +1,95 @@
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+
+#include "pacer.h"
+#include "input.h"
+
+static double frame_pacer_cpu()
+{
+    return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+void frame_pacer_init(frame_pacer_t* pacer, pace_mode_t mode, int fps, double spin_seconds)
+{
+    *pacer = {};
+    pacer->mode = mode;
+    pacer->interval = fps > 0 ? 1000000000ll / fps : 0;
+    pacer->spin = static_cast<long long>(spin_seconds * 1e9);
+    pacer->started = input_time();
+    pacer->deadline = pacer->started;
+    pacer->cpu_started = frame_pacer_cpu();
+}
+
+void frame_pacer_wait(frame_pacer_t* pacer)
+{
+    if(pacer->mode == PACE_CAPPED && pacer->interval > 0)
+    {
+        long long now = input_time();
+        if(now > pacer->deadline)
+        {
+            // late: start now and pace from here rather than rushing to catch up
+            if(pacer->last != 0) pacer->missed++;
+            pacer->deadline = now;
+        }
+        else
+        {
+            long long sleep = pacer->deadline - now - pacer->spin;
+            if(sleep > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(sleep));
+            while(input_time() < pacer->deadline) {}
+        }
+        pacer->deadline += pacer->interval;
+    }
+
+    long long now = input_time();
+    if(pacer->last != 0)
+    {
+        long long frame_time = now - pacer->last;
+        latency_record(&pacer->frame_times, frame_time);
+        pacer->sum += frame_time;
+        pacer->sum_squares += static_cast<double>(frame_time) * frame_time;
+    }
+    pacer->last = now;
+}
+
+const char* frame_pacer_mode_name(pace_mode_t mode)
+{
+    switch(mode)
+    {
+        case PACE_VSYNC: return "vsync";
+        case PACE_CAPPED: return "capped";
+        case PACE_UNCAPPED: return "uncapped";
+    }
+    return "unknown";
+}
+
+bool frame_pacer_parse(const char* name, pace_mode_t* mode)
+{
+    for (int i = PACE_VSYNC; i <= PACE_UNCAPPED; i++)
+    {
+        if(strcmp(name, frame_pacer_mode_name(static_cast<pace_mode_t>(i))) == 0)
+        {
+            *mode = static_cast<pace_mode_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void frame_pacer_print(const frame_pacer_t* pacer, FILE* file)
+{
+    long long frames = pacer->frame_times.total;
+    if(frames == 0) return;
+
+    double mean = pacer->sum / frames;
+    double variance = pacer->sum_squares / frames - mean * mean;
+    double deviation = variance > 0.0 ? sqrt(variance) : 0.0;
+    double wall = (input_time() - pacer->started) * 1e-9;
+    double cpu = frame_pacer_cpu() - pacer->cpu_started;
+
+    fprintf(file, "%s: %lld frames, %.3f ms mean, %.3f ms deviation, %lld missed, %.0f%% of a core\n", frame_pacer_mode_name(pacer->mode),
+        frames, mean * 1e-6, deviation * 1e-6, pacer->missed, wall > 0.0 ? cpu / wall * 100.0 : 0.0);
+    latency_print(&pacer->frame_times, "frame time", file);
+}
@@ -0,0 +1,43 @@
+#ifndef PONG_PACER_H
+#define PONG_PACER_H
+
+#include <stdio.h>
+
+#include "latency.h"
+
+typedef enum
+{
+    PACE_VSYNC,     // the swap waits for the display; tears instead of halving the rate when late, if it can
+    PACE_CAPPED,    // sleeps to each frame's deadline, then spins the last stretch for precision
+    PACE_UNCAPPED   // as fast as it goes, for benchmarks
+} pace_mode_t;
+
+// Starts frames on time. frame_pacer_wait goes at the top of the loop, before polling, so the wait
+// never sits between reading input and showing it.
+typedef struct
+{
+    pace_mode_t mode;
+    long long interval; // nanoseconds per frame when capped
+    long long spin;     // how close to the deadline sleeping stops
+    long long deadline;
+
+    // start to start of consecutive frames
+    long long last;
+    latency_histogram_t frame_times;
+    double sum, sum_squares;
+    long long missed;
+
+    long long started;
+    double cpu_started;
+} frame_pacer_t;
+
+void frame_pacer_init(frame_pacer_t* pacer, pace_mode_t mode, int fps, double spin_seconds);
+void frame_pacer_wait(frame_pacer_t* pacer);
+
+const char* frame_pacer_mode_name(pace_mode_t mode);
+// vsync, capped or uncapped
+bool frame_pacer_parse(const char* name, pace_mode_t* mode);
+// frame time mean, deviation and percentiles, frames that missed their deadline and CPU use
+void frame_pacer_print(const frame_pacer_t* pacer, FILE* file);
+
+#endif
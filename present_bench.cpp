@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "presenter_gl.h"
+#include "renderer.h"
+
+// Presents a played match offscreen through a surfaceless EGL context, which is Mesa's llvmpipe on a
+// machine without a GPU, comparing glDrawPixels with the texture presenter at 0 to 3 PBOs. Submit is
+// the CPU time to hand a frame over, finished includes the driver drawing it; on llvmpipe the texture
+// paths only save on submit and finish no sooner than glDrawPixels.
+
+const int TARGET_WIDTH = 1280;
+const int TARGET_HEIGHT = 640;
+
+double bench_seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool bench_context()
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if(get_platform_display == NULL) return false;
+
+    EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if(display == EGL_NO_DISPLAY || eglInitialize(display, NULL, NULL) == EGL_FALSE) return false;
+    if(eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) return false;
+
+    EGLint attributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configs = 0;
+    eglChooseConfig(display, attributes, &config, 1, &configs);
+
+    EGLContext context = eglCreateContext(display, configs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, NULL);
+    if(context == EGL_NO_CONTEXT) return false;
+
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+}
+
+// there is no window, so everything is drawn into a renderbuffer the size of the window
+GLuint bench_target()
+{
+    GLuint renderbuffer, target;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_WIDTH, TARGET_HEIGHT);
+
+    glGenFramebuffers(1, &target);
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    glViewport(0, 0, TARGET_WIDTH, TARGET_HEIGHT);
+    return target;
+}
+
+// pbo_count -1 is the old glPixelZoom + glDrawPixels path; returns the finished seconds per frame
+double bench_present(int pbo_count, int frames, unsigned char* last_frame, double reference_seconds)
+{
+    simulation_state_t simulation;
+    simulation_init(&simulation, 1);
+    simulation_clock_t simulation_clock;
+    simulation_clock_init(&simulation_clock, DEFAULT_TICK_RATE);
+    simulation_inputs_t inputs = {};
+    inputs.enter = 1;
+
+    framebuffer_t framebuffer;
+    framebuffer_init(&framebuffer, PIXELS_WIDTH, PIXELS_HEIGHT);
+    renderer_background(&framebuffer);
+    render_cache_t render_cache = {};
+
+    gl_presenter_t presenter;
+    unsigned char* pixels = NULL;
+    if(pbo_count >= 0) gl_presenter_init(&presenter, PIXELS_WIDTH, PIXELS_HEIGHT, pbo_count);
+    else pixels = new unsigned char[PIXELS_WIDTH * PIXELS_HEIGHT * 3];
+
+    double submit_seconds = 0.0;
+    double finish_seconds = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        simulation_step(&simulation, inputs, static_cast<float>(simulation_clock.tick_dt));
+        renderer_incremental(&simulation, &framebuffer, &render_cache);
+
+        auto start = std::chrono::steady_clock::now();
+        glClear(GL_COLOR_BUFFER_BIT);
+        if(pbo_count >= 0)
+        {
+            gl_presenter_upload(&presenter, &framebuffer);
+            gl_presenter_draw(&presenter);
+        }
+        else
+        {
+            framebuffer_expand(simd_detect(), &framebuffer, pixels, 3);
+            glRasterPos2f(-1.0f, -1.0f);
+            glPixelZoom(TARGET_WIDTH / PIXELS_WIDTH, TARGET_HEIGHT / PIXELS_HEIGHT);
+            glDrawPixels(PIXELS_WIDTH, PIXELS_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+        }
+        submit_seconds += bench_seconds(start);
+
+        // a swap waits for the frame too; without a window glFinish stands in for it
+        glFinish();
+        finish_seconds += bench_seconds(start);
+    }
+
+    glReadPixels(0, 0, TARGET_WIDTH, TARGET_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, last_frame);
+
+    char name[32];
+    if(pbo_count < 0) snprintf(name, sizeof(name), "drawpixels");
+    else snprintf(name, sizeof(name), "texture %d pbo", pbo_count);
+    printf("%-14s submit %8.1f us/frame  finished %8.1f us/frame", name, submit_seconds / frames * 1e6, finish_seconds / frames * 1e6);
+    if(reference_seconds > 0.0) printf("  %.2fx drawpixels", finish_seconds / frames / reference_seconds);
+    printf("\n");
+
+    if(pbo_count >= 0) gl_presenter_destroy(&presenter);
+    delete[] pixels;
+    framebuffer_destroy(&framebuffer);
+
+    return finish_seconds / frames;
+}
+
+// pong_present_bench [frames]
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+
+    if(frames <= 0 || bench_context() == false)
+    {
+        fprintf(stderr, "usage: %s [frames] (needs EGL with surfaceless OpenGL)\n", argv[0]);
+        return -1;
+    }
+
+    printf("renderer: %s\n", glGetString(GL_RENDERER));
+    bench_target();
+
+    int size = TARGET_WIDTH * TARGET_HEIGHT * 4;
+    unsigned char* reference = new unsigned char[size];
+    unsigned char* last_frame = new unsigned char[size];
+
+    double reference_seconds = bench_present(-1, frames, reference, 0.0);
+    bool identical = true;
+    for (int pbo_count = 0; pbo_count <= PRESENTER_MAX_PBOS; pbo_count++)
+    {
+        bench_present(pbo_count, frames, last_frame, reference_seconds);
+        identical = identical && memcmp(reference, last_frame, size) == 0;
+    }
+    printf("last frames: %s\n", identical ? "identical" : "DIFFER");
+
+    delete[] last_frame;
+    delete[] reference;
+
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include <chrono>
+
+#include "presenter.h"
+#include "profiler.h"
+
+void presenter_present(presenter_t* presenter, const framebuffer_t* framebuffer, arena_t* frame)
+{
+    auto start = std::chrono::steady_clock::now();
+    presenter->present(presenter, framebuffer, frame);
+    presenter->present_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    presenter->frames++;
+}
+
+void presenter_destroy(presenter_t* presenter)
+{
+    if(presenter->destroy != NULL) presenter->destroy(presenter);
+    *presenter = {};
+}
+
+static void null_present(presenter_t*, const framebuffer_t*, arena_t*)
+{
+}
+
+void presenter_null_init(presenter_t* presenter)
+{
+    *presenter = {};
+    presenter->name = "null";
+    presenter->present = null_present;
+}
+
+static void offscreen_present(presenter_t* presenter, const framebuffer_t* framebuffer, arena_t* frame)
+{
+    offscreen_target_t* target = static_cast<offscreen_target_t*>(presenter->backend);
+    if(framebuffer->width != target->width || framebuffer->height != target->height) return;
+
+    PROFILE_ZONE("upscale");
+    framebuffer_upscale(target->isa, framebuffer, target->scale, target->pixels, target->channels, frame);
+}
+
+static void offscreen_destroy(presenter_t* presenter)
+{
+    offscreen_target_t* target = static_cast<offscreen_target_t*>(presenter->backend);
+    delete[] target->pixels;
+    delete target;
+}
+
+void presenter_offscreen_init(presenter_t* presenter, int width, int height, int channels, int scale)
+{
+    offscreen_target_t* target = new offscreen_target_t;
+    target->width = width;
+    target->height = height;
+    target->channels = channels;
+    target->scale = scale;
+    target->pixels = new unsigned char[width * scale * height * scale * channels]();
+    target->isa = simd_detect();
+
+    *presenter = {};
+    presenter->name = "offscreen";
+    presenter->backend = target;
+    presenter->present = offscreen_present;
+    presenter->destroy = offscreen_destroy;
+}
+
+const offscreen_target_t* presenter_offscreen_target(const presenter_t* presenter)
+{
+    return static_cast<const offscreen_target_t*>(presenter->backend);
+}
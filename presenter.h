@@ -0,0 +1,44 @@
+#ifndef PONG_PRESENTER_H
+#define PONG_PRESENTER_H
+
+#include "framebuffer.h"
+
+// the window shows the framebuffer this many times larger
+const int PRESENTER_SCALE = 10;
+
+// Where finished frames go. Backends fill in the function pointers and keep their own state behind
+// backend; the game loop only ever calls presenter_present, so it runs the same with or without GL.
+// Scratch memory for a frame comes from the frame arena, never the heap.
+typedef struct presenter_s
+{
+    const char* name;
+    void* backend;
+    void (*present)(struct presenter_s* presenter, const framebuffer_t* framebuffer, arena_t* frame);
+    void (*destroy)(struct presenter_s* presenter);
+
+    // time spent inside present, to tell presentation cost from simulation and rendering
+    double present_seconds;
+    long long frames;
+} presenter_t;
+
+void presenter_present(presenter_t* presenter, const framebuffer_t* framebuffer, arena_t* frame);
+void presenter_destroy(presenter_t* presenter);
+
+// discards every frame
+void presenter_null_init(presenter_t* presenter);
+
+// Keeps the last frame in memory, expanded to channels bytes per pixel and scaled up by a whole factor
+// the way a window would show it, for servers, screenshots and tests. width and height are the
+// framebuffer's; pixels holds (width * scale) x (height * scale) pixels.
+typedef struct
+{
+    int width, height, channels;
+    int scale;
+    unsigned char* pixels;
+    simd_isa_t isa;
+} offscreen_target_t;
+
+void presenter_offscreen_init(presenter_t* presenter, int width, int height, int channels, int scale);
+const offscreen_target_t* presenter_offscreen_target(const presenter_t* presenter);
+
+#endif
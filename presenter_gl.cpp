@@ -0,0 +1,99 @@
+#include <chrono>
+
+#include "presenter_gl.h"
+#include "profiler.h"
+
+void gl_presenter_init(gl_presenter_t* presenter, int width, int height, int pbo_count)
+{
+    *presenter = {};
+    presenter->width = width;
+    presenter->height = height;
+    presenter->pbo_count = pbo_count < PRESENTER_MAX_PBOS ? pbo_count : PRESENTER_MAX_PBOS;
+    presenter->isa = simd_detect();
+
+    glGenTextures(1, &presenter->texture);
+    glBindTexture(GL_TEXTURE_2D, presenter->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if(presenter->pbo_count > 0)
+    {
+        glGenBuffers(presenter->pbo_count, presenter->pbos);
+        for (int i = 0; i < presenter->pbo_count; i++)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, presenter->pbos[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, width * height * 4, NULL, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        presenter->staging = new unsigned char[width * height * 4];
+    }
+}
+
+void gl_presenter_destroy(gl_presenter_t* presenter)
+{
+    if(presenter->pbo_count > 0) glDeleteBuffers(presenter->pbo_count, presenter->pbos);
+    glDeleteTextures(1, &presenter->texture);
+    delete[] presenter->staging;
+    *presenter = {};
+}
+
+void gl_presenter_upload(gl_presenter_t* presenter, const framebuffer_t* framebuffer)
+{
+    PROFILE_ZONE("texture upload");
+    auto start = std::chrono::steady_clock::now();
+    int size = presenter->width * presenter->height * 4;
+
+    glBindTexture(GL_TEXTURE_2D, presenter->texture);
+    if(presenter->pbo_count > 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, presenter->pbos[presenter->next_pbo]);
+        presenter->next_pbo = (presenter->next_pbo + 1) % presenter->pbo_count;
+
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        unsigned char* mapped = static_cast<unsigned char*>(glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+        if(mapped != NULL)
+        {
+            framebuffer_expand(presenter->isa, framebuffer, mapped, 4);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+            // the source is an offset into the bound PBO, so the copy can happen whenever the driver likes
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, presenter->width, presenter->height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        framebuffer_expand(presenter->isa, framebuffer, presenter->staging, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, presenter->width, presenter->height, GL_RGBA, GL_UNSIGNED_BYTE, presenter->staging);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    presenter->upload_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    presenter->frames++;
+}
+
+void gl_presenter_draw(const gl_presenter_t* presenter)
+{
+    PROFILE_ZONE("texture draw");
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, presenter->texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    // the framebuffer's first row is the bottom one, which is where texture row 0 goes
+    glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+        glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, -1.0f);
+        glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+        glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
+    glEnd();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
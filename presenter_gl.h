@@ -0,0 +1,43 @@
+#ifndef PONG_PRESENTER_GL_H
+#define PONG_PRESENTER_GL_H
+
+#if defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#endif
+
+#include "framebuffer.h"
+
+const int PRESENTER_MAX_PBOS = 3;
+
+// Keeps the frame in a persistent RGBA texture and streams each new frame into it through a ring of
+// pixel buffer objects. Each PBO is orphaned before it is mapped, so the driver hands out fresh memory
+// instead of waiting for the previous upload from it. The 1bpp framebuffer is expanded straight into
+// the mapped buffer. With pbo_count 0 the texture is updated from client memory instead, for comparison.
+// Needs a current GL 2.1 context.
+typedef struct
+{
+    int width, height;
+    int pbo_count;
+    int next_pbo;
+    GLuint texture;
+    GLuint pbos[PRESENTER_MAX_PBOS];
+    unsigned char* staging;
+    simd_isa_t isa;
+
+    // CPU time spent expanding and uploading
+    double upload_seconds;
+    long long frames;
+} gl_presenter_t;
+
+void gl_presenter_init(gl_presenter_t* presenter, int width, int height, int pbo_count);
+void gl_presenter_destroy(gl_presenter_t* presenter);
+
+void gl_presenter_upload(gl_presenter_t* presenter, const framebuffer_t* framebuffer);
+// nearest-filtered quad over the current viewport
+void gl_presenter_draw(const gl_presenter_t* presenter);
+
+#endif
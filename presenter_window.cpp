@@ -0,0 +1,44 @@
+#include "presenter_window.h"
+#include "profiler.h"
+
+typedef struct
+{
+    GLFWwindow* window;
+    gl_presenter_t gl;
+} window_target_t;
+
+static void window_present(presenter_t* presenter, const framebuffer_t* framebuffer, arena_t*)
+{
+    window_target_t* target = static_cast<window_target_t*>(presenter->backend);
+
+    int window_width, window_height;
+    glfwGetFramebufferSize(target->window, &window_width, &window_height);
+    glViewport(0, 0, window_width, window_height);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    gl_presenter_upload(&target->gl, framebuffer);
+    gl_presenter_draw(&target->gl);
+
+    PROFILE_ZONE("glfwSwapBuffers");
+    glfwSwapBuffers(target->window);
+}
+
+static void window_destroy(presenter_t* presenter)
+{
+    window_target_t* target = static_cast<window_target_t*>(presenter->backend);
+    gl_presenter_destroy(&target->gl);
+    delete target;
+}
+
+void presenter_window_init(presenter_t* presenter, GLFWwindow* window, int width, int height)
+{
+    window_target_t* target = new window_target_t;
+    target->window = window;
+    gl_presenter_init(&target->gl, width, height, PRESENTER_MAX_PBOS);
+
+    *presenter = {};
+    presenter->name = "window";
+    presenter->backend = target;
+    presenter->present = window_present;
+    presenter->destroy = window_destroy;
+}
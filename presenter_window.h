@@ -0,0 +1,13 @@
+#ifndef PONG_PRESENTER_WINDOW_H
+#define PONG_PRESENTER_WINDOW_H
+
+#include "presenter_gl.h"
+#include <GLFW/glfw3.h>
+
+#include "presenter.h"
+
+// Presents width x height frames into a GLFW window through gl_presenter_t and swaps.
+// The window's context has to be current.
+void presenter_window_init(presenter_t* presenter, GLFWwindow* window, int width, int height);
+
+#endif
@@ -0,0 +1,135 @@
+#include <string.h>
+#include <chrono>
+
+#include "profiler.h"
+
+profiler_t global_profiler;
+
+void profiler_init(bool enabled)
+{
+    profiler_t* profiler = &global_profiler;
+    profiler->enabled = enabled;
+    if(enabled == false) return;
+
+    if(profiler->events == NULL) profiler->events = new profile_event_t[PROFILER_EVENTS];
+    if(profiler->frames == NULL) profiler->frames = new profile_frame_t[PROFILER_FRAMES]();
+    profiler->event_count = 0;
+    profiler->frame_count = 0;
+    profiler->origin = profiler_now();
+}
+
+void profiler_destroy()
+{
+    profiler_t* profiler = &global_profiler;
+    delete[] profiler->events;
+    delete[] profiler->frames;
+    profiler->events = NULL;
+    profiler->frames = NULL;
+    profiler->enabled = false;
+}
+
+long long profiler_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int profiler_zone(const char* name)
+{
+    profiler_t* profiler = &global_profiler;
+    for (int zone = 0; zone < profiler->zone_count; zone++)
+    {
+        if(strcmp(profiler->zone_names[zone], name) == 0) return zone;
+    }
+
+    if(profiler->zone_count == PROFILER_ZONES) return PROFILER_ZONES - 1;
+    profiler->zone_names[profiler->zone_count] = name;
+    return profiler->zone_count++;
+}
+
+void profiler_record(int zone, long long begin, long long end)
+{
+    profiler_t* profiler = &global_profiler;
+    if(profiler->enabled == false) return;
+
+    profiler->events[profiler->event_count % PROFILER_EVENTS] = {zone, begin, end};
+    profiler->event_count++;
+
+    profile_frame_t* frame = &profiler->frames[profiler->frame_count % PROFILER_FRAMES];
+    frame->zone_time[zone] += end - begin;
+    frame->zone_calls[zone]++;
+}
+
+void profiler_frame_begin()
+{
+    profiler_t* profiler = &global_profiler;
+    if(profiler->enabled == false) return;
+
+    profile_frame_t* frame = &profiler->frames[profiler->frame_count % PROFILER_FRAMES];
+    *frame = {};
+    frame->begin = profiler_now();
+}
+
+void profiler_frame_end()
+{
+    profiler_t* profiler = &global_profiler;
+    if(profiler->enabled == false) return;
+
+    static const int frame_zone = profiler_zone("frame");
+    profile_frame_t* frame = &profiler->frames[profiler->frame_count % PROFILER_FRAMES];
+    frame->end = profiler_now();
+    profiler_record(frame_zone, frame->begin, frame->end);
+    profiler->frame_count++;
+}
+
+void profiler_print(FILE* file)
+{
+    const profiler_t* profiler = &global_profiler;
+    if(profiler->enabled == false || profiler->frame_count == 0) return;
+
+    int frames = profiler->frame_count < PROFILER_FRAMES ? static_cast<int>(profiler->frame_count) : PROFILER_FRAMES;
+    long long frame_total = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        frame_total += profiler->frames[i].end - profiler->frames[i].begin;
+    }
+
+    fprintf(file, "profile of the last %d frames, %.1f us per frame\n", frames, frame_total * 1e-3 / frames);
+    for (int zone = 0; zone < profiler->zone_count; zone++)
+    {
+        long long total = 0;
+        long long worst = 0;
+        long long calls = 0;
+        for (int i = 0; i < frames; i++)
+        {
+            const profile_frame_t* frame = &profiler->frames[i];
+            total += frame->zone_time[zone];
+            calls += frame->zone_calls[zone];
+            if(frame->zone_time[zone] > worst) worst = frame->zone_time[zone];
+        }
+        if(calls == 0) continue;
+
+        fprintf(file, "  %-20s %9.2f us mean  %9.2f us worst  %6.2f calls per frame\n", profiler->zone_names[zone],
+            total * 1e-3 / frames, worst * 1e-3, static_cast<double>(calls) / frames);
+    }
+}
+
+bool profiler_write_trace(const char* path)
+{
+    const profiler_t* profiler = &global_profiler;
+    FILE* file = fopen(path, "w");
+    if(file == NULL) return false;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"game\"}}");
+
+    long long first = profiler->event_count > PROFILER_EVENTS ? profiler->event_count - PROFILER_EVENTS : 0;
+    for (long long i = first; profiler->events != NULL && i < profiler->event_count; i++)
+    {
+        const profile_event_t* event = &profiler->events[i % PROFILER_EVENTS];
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", profiler->zone_names[event->zone],
+            (event->begin - profiler->origin) * 1e-3, (event->end - event->begin) * 1e-3);
+    }
+
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
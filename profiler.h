@@ -0,0 +1,79 @@
+#ifndef PONG_PROFILER_H
+#define PONG_PROFILER_H
+
+#include <stdio.h>
+
+const int PROFILER_EVENTS = 1 << 16;
+const int PROFILER_FRAMES = 256;
+const int PROFILER_ZONES = 32;
+
+typedef struct
+{
+    int zone;
+    long long begin, end;
+} profile_event_t;
+
+// what each zone cost inside one frame
+typedef struct
+{
+    long long begin, end;
+    long long zone_time[PROFILER_ZONES];
+    int zone_calls[PROFILER_ZONES];
+} profile_frame_t;
+
+// Scoped zones recorded into a ring of the latest events and a ring of per-frame totals, both taken
+// at init so recording never allocates. Game thread only. Disabled, a zone costs one branch.
+typedef struct
+{
+    bool enabled;
+    const char* zone_names[PROFILER_ZONES];
+    int zone_count;
+
+    profile_event_t* events;
+    long long event_count; // ever recorded; the ring holds the last PROFILER_EVENTS
+    profile_frame_t* frames;
+    long long frame_count;
+
+    long long origin;
+} profiler_t;
+
+extern profiler_t global_profiler;
+
+void profiler_init(bool enabled);
+void profiler_destroy();
+
+// steady clock nanoseconds; as cheap as rdtsc on current systems and needs no calibration
+long long profiler_now();
+
+// index of the zone called name, added on first use; zones past PROFILER_ZONES share the last one
+int profiler_zone(const char* name);
+void profiler_record(int zone, long long begin, long long end);
+
+void profiler_frame_begin();
+void profiler_frame_end();
+
+// mean and worst time per frame and calls per frame of every zone, over the frames in the ring
+void profiler_print(FILE* file);
+// the event ring as Chrome trace event JSON, for chrome://tracing or Perfetto; false if path can't be written
+bool profiler_write_trace(const char* path);
+
+struct profile_scope_t
+{
+    int zone;
+    long long begin;
+
+    explicit profile_scope_t(int zone) : zone(zone), begin(global_profiler.enabled ? profiler_now() : 0) {}
+    ~profile_scope_t()
+    {
+        if(begin != 0) profiler_record(zone, begin, profiler_now());
+    }
+};
+
+#define PROFILE_JOIN_(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_(a, b)
+// times the rest of the enclosing scope as zone name
+#define PROFILE_ZONE(name) \
+    static const int PROFILE_JOIN(profile_zone_, __LINE__) = profiler_zone(name); \
+    profile_scope_t PROFILE_JOIN(profile_scope_, __LINE__)(PROFILE_JOIN(profile_zone_, __LINE__))
+
+#endif
@@ -0,0 +1,230 @@
+#include "renderer.h"
+#include "profiler.h"
+
+const int SCORE_TOP = (PIXELS_HEIGHT - 1) - SCORE_Y_OFFSET;
+// the right player's score sits left of the net and grows away from it, the left player's the other way
+const int RIGHT_SCORE_END = (PIXELS_WIDTH / 2) - SCORE_X_OFFSET;
+const int LEFT_SCORE_X = (PIXELS_WIDTH / 2) + SCORE_X_OFFSET;
+
+static rect_t score_rect(int score, bool right)
+{
+    int width = number_width(score);
+    return {right ? RIGHT_SCORE_END - width : LEFT_SCORE_X, SCORE_TOP - (GLYPH_HEIGHT - 1), width, GLYPH_HEIGHT};
+}
+
+void renderer_background(framebuffer_t* framebuffer)
+{
+    framebuffer_t layer;
+    framebuffer_init(&layer, framebuffer->width, framebuffer->height);
+    render_net(&layer);
+    framebuffer_set_background(framebuffer, &layer);
+    framebuffer_destroy(&layer);
+}
+
+void renderer_system(simulation_state_t* state, framebuffer_t* framebuffer, framebuffer_clear_t mode)
+{
+    PROFILE_ZONE("renderer_system");
+    framebuffer_clear(framebuffer, mode);
+    render_entities(&state->entity_manager, framebuffer);
+
+    render_number(framebuffer, state->right_score, score_rect(state->right_score, true));
+    render_number(framebuffer, state->left_score, score_rect(state->left_score, false));
+}
+
+static void render_item(framebuffer_t* framebuffer, const render_item_t* item)
+{
+    if(item->score_slot < 0) framebuffer_fill_rect(framebuffer, item->rect, true);
+    else render_number(framebuffer, item->score, item->rect);
+}
+
+// the same thing on screen: the same entity, or the same player's score
+static bool render_item_same(const render_item_t* a, const render_item_t* b)
+{
+    return a->entity == b->entity && a->score_slot == b->score_slot;
+}
+
+static bool render_item_find(const std::vector<render_item_t>& items, const render_item_t* item, bool* unchanged)
+{
+    for (int i = 0; i < static_cast<int>(items.size()); i++)
+    {
+        if(render_item_same(&items[i], item) == false) continue;
+
+        *unchanged = rect_equal(items[i].rect, item->rect) && items[i].score == item->score;
+        return true;
+    }
+    return false;
+}
+
+void renderer_incremental(simulation_state_t* state, framebuffer_t* framebuffer, render_cache_t* cache)
+{
+    PROFILE_ZONE("renderer_incremental");
+    framebuffer->touched = 0;
+    framebuffer->dirty.clear();
+
+    std::vector<render_item_t>* next = &cache->next;
+    next->clear();
+    next->push_back({NULL_ENTITY, score_rect(state->right_score, true), 0, state->right_score});
+    next->push_back({NULL_ENTITY, score_rect(state->left_score, false), 1, state->left_score});
+    entity_each_handle<extension_t, position_t, renderer_t>(&state->entity_manager, [next](int rows, entity_t* entities, extension_t* extensions, position_t* positions, renderer_t* renderers)
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            if(renderers[row].visible == false) continue;
+            next->push_back({entities[row], {positions[row].pixel_x, positions[row].pixel_y, extensions[row].w, extensions[row].h}, -1, 0});
+        }
+    });
+
+    // erase whatever moved, changed or went away
+    cache->erased.clear();
+    for (int i = 0; i < static_cast<int>(cache->items.size()); i++)
+    {
+        bool unchanged = false;
+        if(render_item_find(*next, &cache->items[i], &unchanged) && unchanged) continue;
+
+        framebuffer_erase_rect(framebuffer, cache->items[i].rect);
+        cache->erased.push_back(cache->items[i].rect);
+    }
+
+    // draw what is new, and what an erase cut into
+    for (int i = 0; i < static_cast<int>(next->size()); i++)
+    {
+        const render_item_t* item = &(*next)[i];
+
+        bool unchanged = false;
+        bool redraw = render_item_find(cache->items, item, &unchanged) == false || unchanged == false;
+        for (int e = 0; e < static_cast<int>(cache->erased.size()) && redraw == false; e++)
+        {
+            redraw = rect_overlap(item->rect, cache->erased[e]);
+        }
+
+        if(redraw) render_item(framebuffer, item);
+    }
+
+    cache->items.swap(*next);
+    cache->pixels_touched = framebuffer->touched;
+}
+
+static bool layer_init(framebuffer_t* layer, int width, int height, arena_t* arena)
+{
+    if(arena != NULL) return framebuffer_init_arena(layer, width, height, arena);
+
+    framebuffer_init(layer, width, height);
+    return true;
+}
+
+bool render_layers_init(render_layers_t* layers, int width, int height, arena_t* arena)
+{
+    *layers = {};
+    if(layer_init(&layers->background, width, height, arena) == false) return false;
+    if(layer_init(&layers->hud, width, height, arena) == false) return false;
+    if(layer_init(&layers->sprites, width, height, arena) == false) return false;
+    render_net(&layers->background);
+    layers->scores[0] = -1;
+    layers->scores[1] = -1;
+
+    // room for every layer's old and new rects, so a frame never grows it
+    layers->changed.reserve(64);
+    return true;
+}
+
+void render_layers_destroy(render_layers_t* layers)
+{
+    framebuffer_destroy(&layers->sprites);
+    framebuffer_destroy(&layers->hud);
+    framebuffer_destroy(&layers->background);
+}
+
+// clears the layer's last drawing and remembers both that and what is drawn next as changed
+static void layer_begin(framebuffer_t* layer, std::vector<rect_t>* changed)
+{
+    changed->insert(changed->end(), layer->dirty.begin(), layer->dirty.end());
+    layer->touched = 0;
+    framebuffer_clear(layer, CLEAR_DIRTY);
+}
+
+static long long layer_end(framebuffer_t* layer, std::vector<rect_t>* changed)
+{
+    changed->insert(changed->end(), layer->dirty.begin(), layer->dirty.end());
+    return layer->touched;
+}
+
+void renderer_layered(simulation_state_t* state, framebuffer_t* framebuffer, render_layers_t* layers)
+{
+    PROFILE_ZONE("renderer_layered");
+    std::vector<rect_t>* changed = &layers->changed;
+    changed->clear();
+    layers->pixels_touched = 0;
+    framebuffer->touched = 0;
+
+    if(layers->frames == 0) changed->push_back({0, 0, framebuffer->width, framebuffer->height});
+
+    if(state->right_score != layers->scores[0] || state->left_score != layers->scores[1])
+    {
+        layer_begin(&layers->hud, changed);
+        render_number(&layers->hud, state->right_score, score_rect(state->right_score, true));
+        render_number(&layers->hud, state->left_score, score_rect(state->left_score, false));
+        layers->pixels_touched += layer_end(&layers->hud, changed);
+
+        layers->scores[0] = state->right_score;
+        layers->scores[1] = state->left_score;
+    }
+
+    layer_begin(&layers->sprites, changed);
+    render_entities(&state->entity_manager, &layers->sprites);
+    layers->pixels_touched += layer_end(&layers->sprites, changed);
+
+    const framebuffer_t* stack[3] = {&layers->background, &layers->hud, &layers->sprites};
+    for (int i = 0; i < static_cast<int>(changed->size()); i++)
+    {
+        framebuffer_compose(framebuffer, stack, 3, (*changed)[i]);
+    }
+
+    layers->pixels_touched += framebuffer->touched;
+    layers->frames++;
+}
+
+void render_net(framebuffer_t* framebuffer)
+{
+    for (int y = 1; y < framebuffer->height; y += 2)
+    {
+        framebuffer_fill_rect(framebuffer, {NET_X, y, 1, 1}, true);
+    }
+}
+
+void render_entities(entity_manager_t* entity_manager, framebuffer_t* framebuffer)
+{
+    entity_each<extension_t, position_t, renderer_t>(entity_manager, [framebuffer](int rows, extension_t* extensions, position_t* positions, renderer_t* renderers)
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            if(renderers[row].visible == false) continue;
+
+            extension_t size = extensions[row];
+            position_t position = positions[row];
+            framebuffer_fill_rect(framebuffer, {position.pixel_x, position.pixel_y, size.w, size.h}, true);
+        }
+    });
+}
+
+void render_number(framebuffer_t* framebuffer, int number, rect_t rect)
+{
+    PROFILE_ZONE("score blit");
+    // every digit's row shifted into place, so each row of the number is a single blit
+    uint64_t rows[GLYPH_HEIGHT] = {};
+    int digits = number_digits(number);
+    for (int digit = digits - 1; digit >= 0; digit--, number /= 10)
+    {
+        uint16_t glyph = DIGIT_GLYPHS[number % 10];
+        for (int row = 0; row < GLYPH_HEIGHT; row++)
+        {
+            rows[row] |= static_cast<uint64_t>(glyph_row(glyph, row)) << (digit * GLYPH_ADVANCE);
+        }
+    }
+
+    int top = rect.y + GLYPH_HEIGHT - 1;
+    for (int row = 0; row < GLYPH_HEIGHT; row++)
+    {
+        framebuffer_blit_row(framebuffer, rect.x, top - row, rows[row], rect.w);
+    }
+    framebuffer_mark_dirty(framebuffer, rect);
+}
@@ -0,0 +1,75 @@
+#ifndef PONG_RENDERER_H
+#define PONG_RENDERER_H
+
+#include "simulation.h"
+#include "framebuffer.h"
+#include "glyphs.h"
+
+const int SCORE_X_OFFSET = 4;
+const int SCORE_Y_OFFSET = 2;
+// The net is a dashed column down the middle, one pixel on and one off from the second row up. One
+// framebuffer pixel is as thin as it gets, 10 screen pixels at PRESENTER_SCALE, where the old GL
+// stipple line was 3.
+const int NET_X = PIXELS_WIDTH / 2;
+
+// Something on screen: a solid entity rect, or a player's score.
+typedef struct
+{
+    entity_t entity; // NULL_ENTITY for the scores
+    rect_t rect;
+    int score_slot; // -1 for entities, 0 right player, 1 left player
+    int score;
+} render_item_t;
+
+// What the framebuffer shows after the last incremental frame.
+typedef struct
+{
+    std::vector<render_item_t> items;
+    std::vector<render_item_t> next;
+    std::vector<rect_t> erased;
+
+    // pixels cleared or drawn by the last frame
+    long long pixels_touched;
+} render_cache_t;
+
+// Makes the net the framebuffer's background, so every clear and erase puts it back.
+void renderer_background(framebuffer_t* framebuffer);
+
+// The scene in three cached layers: the static background, the scores, which are only redrawn when one
+// changes, and the moving sprites. Each frame only the rects a layer changed are composed into the
+// framebuffer, so the cost follows the sprites.
+typedef struct
+{
+    framebuffer_t background;
+    framebuffer_t hud;
+    framebuffer_t sprites;
+
+    int scores[2];      // what hud shows, right player first
+    long long frames;
+    std::vector<rect_t> changed;
+
+    // pixels drawn into layers or composed by the last frame
+    long long pixels_touched;
+} render_layers_t;
+
+// Layers come from arena, or the heap when it is NULL; false when arena has no room for all three.
+bool render_layers_init(render_layers_t* layers, int width, int height, arena_t* arena);
+void render_layers_destroy(render_layers_t* layers);
+
+// Clears the framebuffer with mode and draws the visible entities and both scores.
+void renderer_system(simulation_state_t* state, framebuffer_t* framebuffer, framebuffer_clear_t mode);
+
+// Erases what moved or changed since the last frame and draws it again, along with anything the erase
+// cut into, so the cost follows motion instead of resolution. The framebuffer has to show only its
+// background and be drawn by nothing else from the first frame on.
+void renderer_incremental(simulation_state_t* state, framebuffer_t* framebuffer, render_cache_t* cache);
+
+// Updates the layers and composes what changed into the framebuffer, which is drawn by nothing else.
+void renderer_layered(simulation_state_t* state, framebuffer_t* framebuffer, render_layers_t* layers);
+
+void render_net(framebuffer_t* framebuffer);
+void render_entities(entity_manager_t* entity_manager, framebuffer_t* framebuffer);
+// number (not negative) in digits GLYPH_ADVANCE apart, filling rect, which is number_width wide
+void render_number(framebuffer_t* framebuffer, int number, rect_t rect);
+
+#endif
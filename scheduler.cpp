@@ -0,0 +1,247 @@
+#include "scheduler.h"
+
+static void scheduler_push(scheduler_t* scheduler, int worker, int job)
+{
+    job_queue_t* queue = &scheduler->queues[worker];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->jobs.push_back(job);
+}
+
+static bool scheduler_pop(scheduler_t* scheduler, int worker, int* job)
+{
+    job_queue_t* queue = &scheduler->queues[worker];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if(queue->jobs.empty()) return false;
+
+    *job = queue->jobs.back();
+    queue->jobs.pop_back();
+    return true;
+}
+
+static bool scheduler_steal(scheduler_t* scheduler, int worker, int* job)
+{
+    for (int i = 1; i < scheduler->thread_count; i++)
+    {
+        job_queue_t* queue = &scheduler->queues[(worker + i) % scheduler->thread_count];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if(queue->jobs.empty()) continue;
+
+        *job = queue->jobs.front();
+        queue->jobs.pop_front();
+        scheduler->steals++;
+        return true;
+    }
+    return false;
+}
+
+static void scheduler_release(scheduler_t* scheduler, int worker, int job)
+{
+    if(scheduler->job_dependencies[job].fetch_sub(1) == 1) scheduler_push(scheduler, worker, job);
+}
+
+static void scheduler_complete(scheduler_t* scheduler, int worker, int job_index)
+{
+    const job_t* job = &scheduler->jobs[job_index];
+    for (int i = 0; i < static_cast<int>(job->dependents.size()); i++)
+    {
+        scheduler_release(scheduler, worker, job->dependents[i]);
+    }
+
+    // last job of its system: release the systems waiting on all of it
+    if(scheduler->system_pending[job->system].fetch_sub(1) == 1)
+    {
+        const std::vector<int>& dependents = scheduler->system_dependents[job->system];
+        for (int i = 0; i < static_cast<int>(dependents.size()); i++)
+        {
+            int system = dependents[i];
+            for (int next = scheduler->system_first_job[system]; next < scheduler->system_first_job[system + 1]; next++)
+            {
+                scheduler_release(scheduler, worker, next);
+            }
+        }
+    }
+
+    // only after everything it released is queued, so nobody sees zero while work is still coming
+    scheduler->remaining--;
+}
+
+static void scheduler_work(scheduler_t* scheduler, int worker)
+{
+    while(scheduler->remaining.load() > 0)
+    {
+        int job;
+        if(scheduler_pop(scheduler, worker, &job) || scheduler_steal(scheduler, worker, &job))
+        {
+            const job_t* current = &scheduler->jobs[job];
+            const system_desc_t* system = &scheduler->systems[current->system];
+            system->function(system->context, current->begin, current->end);
+            scheduler_complete(scheduler, worker, job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+static void scheduler_thread(scheduler_t* scheduler, int worker)
+{
+    int frame = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(scheduler->mutex);
+            scheduler->wake.wait(lock, [&] { return scheduler->quit || scheduler->frame != frame; });
+            if(scheduler->quit) return;
+            frame = scheduler->frame;
+        }
+
+        scheduler_work(scheduler, worker);
+
+        if(scheduler->active.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(scheduler->mutex);
+            scheduler->done.notify_one();
+        }
+    }
+}
+
+void scheduler_init(scheduler_t* scheduler, int thread_count)
+{
+    scheduler->thread_count = thread_count > 0 ? thread_count : 1;
+    scheduler->queues = new job_queue_t[scheduler->thread_count];
+    scheduler->remaining = 0;
+    scheduler->active = 0;
+    scheduler->frame = 0;
+    scheduler->quit = false;
+    scheduler->steals = 0;
+
+    for (int worker = 1; worker < scheduler->thread_count; worker++)
+    {
+        scheduler->threads.emplace_back(scheduler_thread, scheduler, worker);
+    }
+}
+
+void scheduler_destroy(scheduler_t* scheduler)
+{
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        scheduler->quit = true;
+    }
+    scheduler->wake.notify_all();
+
+    for (int i = 0; i < static_cast<int>(scheduler->threads.size()); i++)
+    {
+        scheduler->threads[i].join();
+    }
+    scheduler->threads.clear();
+
+    delete[] scheduler->queues;
+    scheduler->queues = nullptr;
+}
+
+int scheduler_add_system(scheduler_t* scheduler, system_desc_t system)
+{
+    if(system.grain <= 0) system.grain = 1;
+    scheduler->systems.push_back(system);
+    return static_cast<int>(scheduler->systems.size()) - 1;
+}
+
+static bool systems_conflict(const system_desc_t* a, const system_desc_t* b)
+{
+    return (a->writes & (b->reads | b->writes)) != 0 || (a->reads & b->writes) != 0;
+}
+
+void scheduler_build(scheduler_t* scheduler)
+{
+    int system_count = static_cast<int>(scheduler->systems.size());
+    scheduler->jobs.clear();
+    scheduler->system_first_job.assign(system_count + 1, 0);
+    scheduler->system_dependents.assign(system_count, std::vector<int>());
+
+    for (int i = 0; i < system_count; i++)
+    {
+        const system_desc_t* system = &scheduler->systems[i];
+        scheduler->system_first_job[i] = static_cast<int>(scheduler->jobs.size());
+
+        // an empty system still gets one empty job so whatever waits on it gets released
+        int begin = 0;
+        do
+        {
+            job_t job = {};
+            job.system = i;
+            job.begin = begin;
+            job.end = begin + system->grain < system->count ? begin + system->grain : system->count;
+            scheduler->jobs.push_back(job);
+            begin += system->grain;
+        } while(begin < system->count);
+    }
+    scheduler->system_first_job[system_count] = static_cast<int>(scheduler->jobs.size());
+
+    for (int later = 0; later < system_count; later++)
+    {
+        const system_desc_t* b = &scheduler->systems[later];
+        for (int earlier = 0; earlier < later; earlier++)
+        {
+            const system_desc_t* a = &scheduler->systems[earlier];
+            if(systems_conflict(a, b) == false) continue;
+
+            if(a->range_local && b->range_local && a->count == b->count && a->grain == b->grain)
+            {
+                int jobs = scheduler->system_first_job[later + 1] - scheduler->system_first_job[later];
+                for (int k = 0; k < jobs; k++)
+                {
+                    scheduler->jobs[scheduler->system_first_job[earlier] + k].dependents.push_back(scheduler->system_first_job[later] + k);
+                    scheduler->jobs[scheduler->system_first_job[later] + k].dependencies++;
+                }
+            }
+            else
+            {
+                scheduler->system_dependents[earlier].push_back(later);
+                for (int job = scheduler->system_first_job[later]; job < scheduler->system_first_job[later + 1]; job++)
+                {
+                    scheduler->jobs[job].dependencies++;
+                }
+            }
+        }
+    }
+
+    scheduler->job_dependencies.reset(new std::atomic<int>[scheduler->jobs.size()]);
+    scheduler->system_pending.reset(new std::atomic<int>[system_count]);
+}
+
+void scheduler_run(scheduler_t* scheduler)
+{
+    int job_count = static_cast<int>(scheduler->jobs.size());
+    if(job_count == 0) return;
+
+    for (int i = 0; i < static_cast<int>(scheduler->systems.size()); i++)
+    {
+        scheduler->system_pending[i] = scheduler->system_first_job[i + 1] - scheduler->system_first_job[i];
+    }
+
+    // the jobs that wait on nothing are dealt out round robin
+    int worker = 0;
+    for (int job = 0; job < job_count; job++)
+    {
+        scheduler->job_dependencies[job] = scheduler->jobs[job].dependencies;
+        if(scheduler->jobs[job].dependencies != 0) continue;
+
+        scheduler_push(scheduler, worker, job);
+        worker = (worker + 1) % scheduler->thread_count;
+    }
+    scheduler->remaining = job_count;
+
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        scheduler->active = scheduler->thread_count - 1;
+        scheduler->frame++;
+    }
+    scheduler->wake.notify_all();
+
+    scheduler_work(scheduler, 0);
+
+    // every worker has to be back waiting before the counters are reset for the next run
+    std::unique_lock<std::mutex> lock(scheduler->mutex);
+    scheduler->done.wait(lock, [&] { return scheduler->active.load() == 0; });
+}
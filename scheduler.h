@@ -0,0 +1,87 @@
+#ifndef PONG_SCHEDULER_H
+#define PONG_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Data a system touches, one bit per group the caller defines. Two systems conflict when either
+// writes something the other reads or writes; conflicting systems run in the order they were added.
+typedef unsigned int access_t;
+
+typedef void (*system_function_t)(void* context, int begin, int end);
+
+typedef struct
+{
+    const char* name;
+    system_function_t function;
+    void* context;
+    access_t reads;
+    access_t writes;
+
+    // [0, count) is split into jobs of grain items
+    int count;
+    int grain;
+
+    // item i only touches data of item i, so a conflicting system with the same count and grain
+    // waits for the matching job only instead of the whole system
+    bool range_local;
+} system_desc_t;
+
+typedef struct
+{
+    int system;
+    int begin, end;
+    int dependencies;
+    std::vector<int> dependents;
+} job_t;
+
+typedef struct
+{
+    std::mutex mutex;
+    std::deque<int> jobs;
+} job_queue_t;
+
+// Runs a fixed graph of systems on a work-stealing pool. Each thread pops the newest job from its
+// own queue and steals the oldest from the others when it runs dry; jobs released by a finished
+// job go to the queue of the thread that finished it. The calling thread is worker 0.
+typedef struct
+{
+    std::vector<system_desc_t> systems;
+    std::vector<job_t> jobs;
+    std::vector<int> system_first_job;
+    std::vector<std::vector<int>> system_dependents;
+
+    std::unique_ptr<std::atomic<int>[]> job_dependencies;
+    std::unique_ptr<std::atomic<int>[]> system_pending;
+    std::atomic<int> remaining;
+
+    int thread_count;
+    job_queue_t* queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::atomic<int> active;
+    int frame;
+    bool quit;
+
+    // jobs taken from another thread's queue, for the benchmark
+    std::atomic<long long> steals;
+} scheduler_t;
+
+void scheduler_init(scheduler_t* scheduler, int thread_count);
+void scheduler_destroy(scheduler_t* scheduler);
+
+int scheduler_add_system(scheduler_t* scheduler, system_desc_t system);
+// splits the systems into jobs and links them; call once after the last scheduler_add_system
+void scheduler_build(scheduler_t* scheduler);
+// runs every job once and returns when all of them have finished
+void scheduler_run(scheduler_t* scheduler);
+
+#endif
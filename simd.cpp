@@ -0,0 +1,24 @@
+#include "simd.h"
+
+simd_isa_t simd_detect()
+{
+#if defined(PONG_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    return SIMD_SSE;
+#elif defined(PONG_SIMD_X86)
+    return SIMD_SSE;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+const char* simd_isa_name(simd_isa_t isa)
+{
+    switch(isa)
+    {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE: return "sse";
+        default: return "scalar";
+    }
+}
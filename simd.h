@@ -0,0 +1,27 @@
+#ifndef PONG_SIMD_H
+#define PONG_SIMD_H
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define PONG_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// wider paths are compiled per function so the rest of the build keeps the baseline instruction set
+#if defined(PONG_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PONG_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PONG_TARGET_AVX2
+#endif
+
+typedef enum
+{
+    SIMD_SCALAR,
+    SIMD_SSE,
+    SIMD_AVX2
+} simd_isa_t;
+
+// widest instruction set this CPU supports, picked once at startup
+simd_isa_t simd_detect();
+const char* simd_isa_name(simd_isa_t isa);
+
+#endif
@@ -0,0 +1,402 @@
+#include <algorithm>
+
+#include "simulation.h"
+#include "profiler.h"
+
+void simulation_init(simulation_state_t* state, unsigned int seed)
+{
+    *state = {};
+    state->random = seed;
+
+    state->left_paddle_rsc = LEFT_PADDLE_RESOURCE;
+    state->right_paddle_rsc = RIGHT_PADDLE_RESOURCE;
+    state->ball_rsc = BALL_RESOURCE;
+
+    entity_manager_t* entity_manager = &state->entity_manager;
+    state->game_state = IDLE;
+
+    state->left_paddle = create_entity(entity_manager, GAME_ENTITY_SIGNATURE);
+    setup_component(entity_manager, state->left_paddle, state->left_paddle_rsc);
+
+    state->right_paddle = create_entity(entity_manager, GAME_ENTITY_SIGNATURE);
+    setup_component(entity_manager, state->right_paddle, state->right_paddle_rsc);
+
+    state->ball = create_entity(entity_manager, GAME_ENTITY_SIGNATURE);
+    setup_component(entity_manager, state->ball, state->ball_rsc);
+    get_movement(entity_manager, state->ball)->dir_x = simulation_random(&state->random) % 2 == 0 ? 1 : -1;
+    get_movement(entity_manager, state->ball)->dir_y = simulation_random(&state->random) % 2 == 0 ? 1 : -1;
+}
+
+void simulation_step(simulation_state_t* state, simulation_inputs_t inputs, float dt)
+{
+    entity_manager_t* entity_manager = &state->entity_manager;
+    entity_t left_paddle = state->left_paddle;
+    entity_t right_paddle = state->right_paddle;
+    entity_t ball = state->ball;
+
+    get_movement(entity_manager, left_paddle)->dir_y = 0;
+    if(inputs.left_paddle_up)
+    {
+        get_movement(entity_manager, left_paddle)->dir_y += 1;
+    }
+    if(inputs.left_paddle_down)
+    {
+        get_movement(entity_manager, left_paddle)->dir_y -= 1;
+    }
+
+    get_movement(entity_manager, right_paddle)->dir_y = 0;
+    if(inputs.right_paddle_up)
+    {
+        get_movement(entity_manager, right_paddle)->dir_y += 1;
+    }
+    if(inputs.right_paddle_down)
+    {
+        get_movement(entity_manager, right_paddle)->dir_y -= 1;
+    }
+
+    movement_system(entity_manager, dt);
+
+    switch(state->game_state)
+    {
+        case IDLE:
+        {
+            if(inputs.enter)
+            {
+                get_movement(entity_manager, ball)->dir_x = simulation_random(&state->random) % 2 == 0 ? 1 : -1;
+                get_movement(entity_manager, ball)->dir_y = simulation_random(&state->random) % 2 == 0 ? 1 : -1;
+
+                get_renderer(entity_manager, ball)->visible = false;
+                get_renderer(entity_manager, left_paddle)->visible = true;
+                get_renderer(entity_manager, right_paddle)->visible = true;
+
+                state->game_state = PREPARATION;
+            }
+            break;
+        }
+        case PREPARATION:
+        {
+            state->seconds += dt;
+            if(state->seconds >= 2.0)
+            {
+                setup_component(entity_manager, ball, state->ball_rsc);
+                get_movement(entity_manager, ball)->dir_y = simulation_random(&state->random) % 2 == 0 ? 1 : -1;
+
+                state->seconds = 0.0;
+                state->point = 0;
+                state->game_state = GAMEPLAY;
+            }
+            break;
+        }
+        case GAMEPLAY:
+        {
+            position_t ball_point = *get_position(entity_manager, ball);
+            extension_t ball_extension = *get_extension(entity_manager, ball);
+
+            if(ball_point.x <= 0 || (ball_point.x + ball_extension.w - 1) >= PIXELS_WIDTH - 1)
+            {
+                if(ball_point.x <= 0)
+                {
+                    state->point = -1;
+                    state->left_score++;
+                }
+                else
+                {
+                    state->point = 1;
+                    state->right_score++;
+                }
+
+                get_renderer(entity_manager, ball)->visible = false;
+                state->game_state = POINT;
+            }
+            break;
+        }
+        case POINT:
+        {
+            state->game_state = PREPARATION;
+
+            if(state->left_score >= WINNING_SCORE || state->right_score >= WINNING_SCORE)
+            {
+                setup_component(entity_manager, ball, state->ball_rsc);
+                setup_component(entity_manager, left_paddle, state->left_paddle_rsc);
+                setup_component(entity_manager, right_paddle, state->right_paddle_rsc);
+
+                state->left_score = state->right_score = 0;
+                state->matches++;
+
+                state->game_state = IDLE;
+            }
+            break;
+        }
+    }
+
+    update_paddle(entity_manager, left_paddle);
+    update_paddle(entity_manager, right_paddle);
+
+    entity_t entities[2] = {left_paddle, right_paddle};
+    update_ball(entity_manager, ball, entities);
+}
+
+int simulation_random(unsigned int* random)
+{
+    // same recurrence as the reference rand(), kept per match
+    *random = *random * 1103515245 + 12345;
+    return (*random / 65536) % 32768;
+}
+
+void simulation_clock_init(simulation_clock_t* clock, int tick_rate)
+{
+    *clock = {};
+    clock->tick_rate = tick_rate > 0 ? tick_rate : DEFAULT_TICK_RATE;
+    clock->tick_dt = 1.0 / clock->tick_rate;
+}
+
+simulation_inputs_t simulation_constant_inputs(void* context, double)
+{
+    return *static_cast<const simulation_inputs_t*>(context);
+}
+
+int simulation_advance(simulation_state_t* state, simulation_clock_t* clock, simulation_inputs_t inputs, double frame_time)
+{
+    return simulation_advance_source(state, clock, simulation_constant_inputs, &inputs, frame_time);
+}
+
+int simulation_advance_source(simulation_state_t* state, simulation_clock_t* clock, simulation_input_source_t source, void* context, double frame_time)
+{
+    clock->accumulator += frame_time;
+
+    int ticks = 0;
+    while(clock->accumulator >= clock->tick_dt && ticks < MAX_TICKS_PER_FRAME)
+    {
+        // what is left in the accumulator after this tick is how long before the frame's end it ends
+        double tick_end = -(clock->accumulator - clock->tick_dt);
+        simulation_step(state, source(context, tick_end), static_cast<float>(clock->tick_dt));
+        clock->accumulator -= clock->tick_dt;
+        ticks++;
+    }
+
+    // after a long stall drop the backlog instead of spiraling further behind
+    if(clock->accumulator >= clock->tick_dt)
+    {
+        clock->accumulator = 0.0;
+    }
+
+    clock->ticks += ticks;
+    clock->alpha = static_cast<float>(clock->accumulator / clock->tick_dt);
+    return ticks;
+}
+
+void simulation_interpolate(simulation_state_t* state, float alpha)
+{
+    entity_each<position_t>(&state->entity_manager, [alpha](int rows, position_t* positions)
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            position_t* position = &positions[row];
+            float x = position->previous_x + (position->x - position->previous_x) * alpha;
+            float y = position->previous_y + (position->y - position->previous_y) * alpha;
+
+            position->pixel_x = static_cast <int> (x);
+            position->pixel_y = static_cast <int> (y);
+        }
+    });
+}
+
+void simulation_latch_init(simulation_latch_t* latch)
+{
+    *latch = {};
+}
+
+static float simulation_clamp(float value, float low, float high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+static void simulation_latch_paddle(entity_manager_t* entity_manager, entity_t paddle, simulation_latch_t* latch, int side, int up, int down, float elapsed, const simulation_clock_t* clock)
+{
+    if(get_renderer(entity_manager, paddle)->visible == false)
+    {
+        latch->shown[side] = false;
+        return;
+    }
+
+    position_t* position = get_position(entity_manager, paddle);
+    movement_t* movement = get_movement(entity_manager, paddle);
+    float top = static_cast<float>(PIXELS_HEIGHT - get_extension(entity_manager, paddle)->h);
+    float step = movement->speed * static_cast<float>(clock->tick_dt);
+
+    // the newest keys' movement over alpha in place of the last tick's, but no further than the
+    // tick that consumes them will go
+    float interpolated = position->previous_y + (position->y - position->previous_y) * clock->alpha;
+    float direction = static_cast<float>((up ? 1 : 0) - (down ? 1 : 0));
+    float consumed = simulation_clamp(position->y + direction * step, 0, top);
+    float y = interpolated + (direction - movement->dir_y) * step * clock->alpha;
+    y = simulation_clamp(y, std::min(interpolated, consumed), std::max(interpolated, consumed));
+
+    if(latch->shown[side])
+    {
+        float last = latch->drawn[side];
+        if(direction != 0)
+        {
+            if((y - last) * direction < 0) y = last;
+        }
+        else if(latch->ahead[side])
+        {
+            float glide = elapsed * step;
+            y = simulation_clamp(y, last - glide, last + glide);
+        }
+    }
+
+    latch->drawn[side] = y;
+    latch->shown[side] = true;
+    latch->ahead[side] = y != interpolated;
+    position->pixel_y = static_cast <int> (y);
+}
+
+void simulation_latch_paddles(simulation_state_t* state, simulation_latch_t* latch, simulation_inputs_t inputs, const simulation_clock_t* clock)
+{
+    // a new match puts the paddles back, which nothing drawn before has to follow
+    if(state->matches != latch->matches)
+    {
+        latch->shown[0] = latch->shown[1] = false;
+        latch->matches = state->matches;
+    }
+
+    // ticks of simulated time since the last latch
+    float elapsed = static_cast<float>(clock->ticks - latch->ticks) + clock->alpha - latch->alpha;
+    latch->ticks = clock->ticks;
+    latch->alpha = clock->alpha;
+
+    simulation_latch_paddle(&state->entity_manager, state->left_paddle, latch, 0, inputs.left_paddle_up, inputs.left_paddle_down, elapsed, clock);
+    simulation_latch_paddle(&state->entity_manager, state->right_paddle, latch, 1, inputs.right_paddle_up, inputs.right_paddle_down, elapsed, clock);
+}
+
+void setup_component(entity_manager_t* entity_manager, entity_t entity, entity_resource_t resource)
+{
+    extension_t* extension = get_extension(entity_manager, entity);
+    if(extension != nullptr)
+    {
+        extension->w = resource.w;
+        extension->h = resource.h;
+    }
+
+    position_t* position = get_position(entity_manager, entity);
+    if(position != nullptr)
+    {
+        position->x = resource.x;
+        position->y = resource.y;
+        position->previous_x = resource.x;
+        position->previous_y = resource.y;
+    }
+
+    movement_t* movement = get_movement(entity_manager, entity);
+    if(movement != nullptr)
+    {
+        movement->speed = resource.speed;
+    }
+
+    renderer_t* renderer = get_renderer(entity_manager, entity);
+    if(renderer != nullptr)
+    {
+        renderer->visible = resource.visible;
+    }
+}
+
+void movement_system(entity_manager_t* entity_manager, float dt)
+{
+    PROFILE_ZONE("movement_system");
+    // only archetypes that have every required component, walked chunk by chunk
+    entity_each<position_t, movement_t>(entity_manager, [dt](int rows, position_t* positions, movement_t* movements)
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            position_t position = positions[row];
+            movement_t movement = movements[row];
+
+            //float m = sqrt(movement.dir_x * movement.dir_x + movement.dir_y * movement.dir_y);
+            //movement.dir_x /= m;
+            //movement.dir_y /= m;
+
+            position.previous_x = position.x;
+            position.previous_y = position.y;
+
+            position.x += movement.dir_x * movement.speed * dt;
+            position.y += movement.dir_y * movement.speed * dt;
+
+            position.pixel_x = static_cast <int> (position.x);
+            position.pixel_y = static_cast <int> (position.y);
+
+            positions[row] = position;
+        }
+    });
+}
+
+void update_ball(entity_manager_t* entity_manager, entity_t ball, entity_t paddles[2])
+{
+    PROFILE_ZONE("update_ball");
+    if(get_renderer(entity_manager, ball)->visible == false) return;
+
+    position_t ball_position = *get_position(entity_manager, ball);
+    extension_t ball_extension = *get_extension(entity_manager, ball);
+    movement_t ball_movement = *get_movement(entity_manager, ball);
+
+    if(ball_position.x <= 0 || (ball_position.x + ball_extension.w - 1) >= PIXELS_WIDTH - 1)
+    {
+        ball_position.x = ball_position.x <= 0 ? 0 : PIXELS_WIDTH - ball_extension.w;
+        ball_movement.dir_x *= -1;
+    }
+    if(ball_position.y <= 0 || (ball_position.y + ball_extension.h - 1) >= PIXELS_HEIGHT - 1)
+    {
+        ball_position.y = ball_position.y <= 0 ? 0 : PIXELS_HEIGHT - ball_extension.h;
+        ball_movement.dir_y *= -1;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        if(get_renderer(entity_manager, paddles[i])->visible == false) continue;
+
+        position_t paddle_point = *get_position(entity_manager, paddles[i]);
+        extension_t paddle_extension = *get_extension(entity_manager, paddles[i]);
+
+        // overlap rather than exact pixel tests, so sub-pixel steps at other tick rates cannot tunnel through
+        if(ball_position.x < paddle_point.x + paddle_extension.w && ball_position.x + ball_extension.w > paddle_point.x)
+        {
+            if(ball_position.y < paddle_point.y + paddle_extension.h && ball_position.y + ball_extension.h > paddle_point.y)
+            {
+                if(ball_movement.dir_x == -1)
+                {
+                    ball_position.x = paddle_point.x + paddle_extension.w;
+                }
+                else if(ball_movement.dir_x == 1)
+                {
+                    ball_position.x = paddle_point.x - ball_extension.w;
+                }
+
+                ball_movement.dir_x *= -1;
+                //ball_movement.speed += 0.1f;
+            }
+        }
+    }
+
+    *get_position(entity_manager, ball) = ball_position;
+    *get_movement(entity_manager, ball) = ball_movement;
+}
+
+void update_paddle(entity_manager_t* entity_manager, entity_t paddle)
+{
+    PROFILE_ZONE("update_paddle");
+    if(get_renderer(entity_manager, paddle)->visible == false) return;
+
+    position_t paddle_point = *get_position(entity_manager, paddle);
+    extension_t paddle_extension = *get_extension(entity_manager, paddle);
+
+    if(paddle_point.y <= 0)
+    {
+        paddle_point.y = 0;
+    }
+    else if(paddle_point.y + paddle_extension.h - 1 >= PIXELS_HEIGHT - 1)
+    {
+        paddle_point.y = PIXELS_HEIGHT - paddle_extension.h;
+    }
+
+    *get_position(entity_manager, paddle) = paddle_point;
+}
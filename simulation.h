@@ -0,0 +1,125 @@
+#ifndef PONG_SIMULATION_H
+#define PONG_SIMULATION_H
+
+#include "ecs.h"
+
+const unsigned int PIXELS_WIDTH = 128;
+const unsigned int PIXELS_HEIGHT = 64;
+
+const int PADDLE_WIDTH = 1;
+const int PADDLE_HEIGHT = 8;
+
+const int WINNING_SCORE = 10;
+
+// pixels per second, one pixel per tick at the default tick rate
+const float ENTITY_SPEED = 60.0f;
+
+const int DEFAULT_TICK_RATE = 60;
+const int MAX_TICKS_PER_FRAME = 8;
+
+typedef enum
+{
+    IDLE,
+    PREPARATION,
+    GAMEPLAY,
+    POINT
+} game_state_t;
+
+typedef struct
+{
+    float x, y;
+    int w, h;
+    float speed;
+    bool visible;
+} entity_resource_t;
+
+const entity_resource_t LEFT_PADDLE_RESOURCE = {2, 2, PADDLE_WIDTH, PADDLE_HEIGHT, ENTITY_SPEED, false};
+const entity_resource_t RIGHT_PADDLE_RESOURCE = {PIXELS_WIDTH - 3, 15, PADDLE_WIDTH, PADDLE_HEIGHT, ENTITY_SPEED, false};
+const entity_resource_t BALL_RESOURCE = {PIXELS_WIDTH / 2, PIXELS_HEIGHT / 2, 1, 1, ENTITY_SPEED, true};
+
+// paddles and ball; paddles carry a renderer too, it is just not visible
+constexpr signature_t GAME_ENTITY_SIGNATURE = component_signature<extension_t, position_t, movement_t, renderer_t>();
+
+typedef struct
+{
+    int left_paddle_up;
+    int left_paddle_down;
+    int right_paddle_up;
+    int right_paddle_down;
+    int enter;
+} simulation_inputs_t;
+
+// Everything one match needs to advance, so it can be stepped without a window or GL context.
+typedef struct
+{
+    entity_manager_t entity_manager;
+
+    entity_t left_paddle;
+    entity_t right_paddle;
+    entity_t ball;
+
+    entity_resource_t left_paddle_rsc;
+    entity_resource_t right_paddle_rsc;
+    entity_resource_t ball_rsc;
+
+    game_state_t game_state;
+    int left_score, right_score;
+    int point;
+    float seconds;
+
+    // per match generator, so matches stepped side by side stay reproducible
+    unsigned int random;
+    int matches;
+} simulation_state_t;
+
+// Fixed timestep driver: frames feed real time in, the simulation only ever sees whole ticks.
+typedef struct
+{
+    int tick_rate;
+    double tick_dt; // as wide as the accumulator, so a frame of exactly one tick is one tick
+    double accumulator;
+    float alpha;
+    long long ticks;
+} simulation_clock_t;
+
+void simulation_init(simulation_state_t* state, unsigned int seed);
+void simulation_step(simulation_state_t* state, simulation_inputs_t inputs, float dt);
+int simulation_random(unsigned int* random);
+
+// Inputs for one tick. tick_end is when that tick's span of simulated time ends, in seconds relative
+// to the end of the frame being advanced, so zero or negative.
+typedef simulation_inputs_t (*simulation_input_source_t)(void* context, double tick_end);
+// the simulation_inputs_t context points at, for every tick
+simulation_inputs_t simulation_constant_inputs(void* context, double tick_end);
+
+void simulation_clock_init(simulation_clock_t* clock, int tick_rate);
+int simulation_advance(simulation_state_t* state, simulation_clock_t* clock, simulation_inputs_t inputs, double frame_time);
+// like simulation_advance, asking source for every tick's inputs
+int simulation_advance_source(simulation_state_t* state, simulation_clock_t* clock, simulation_input_source_t source, void* context, double frame_time);
+void simulation_interpolate(simulation_state_t* state, float alpha);
+// What late latching last drew for each paddle, left then right. While a key is held the paddle is
+// never drawn moving against it, so where the latch got ahead of the simulation it waits for
+// interpolation to catch up instead of snapping back. After a release it glides back at paddle speed.
+typedef struct
+{
+    float drawn[2];
+    bool shown[2];  // drawn by the last latch, in this match
+    bool ahead[2];  // drawn somewhere interpolation doesn't put it
+    long long ticks;
+    float alpha;
+    int matches;
+} simulation_latch_t;
+
+void simulation_latch_init(simulation_latch_t* latch);
+// Draws the visible paddles interpolated like everything else, moved over this part of the tick by
+// inputs instead of by the last tick's, so a key shows before the tick that consumes it. The latch
+// never takes them past where that tick will put them, and with the same keys as the last tick and
+// nothing left to catch up they are drawn where interpolation puts them. Simulated positions stay.
+void simulation_latch_paddles(simulation_state_t* state, simulation_latch_t* latch, simulation_inputs_t inputs, const simulation_clock_t* clock);
+
+void setup_component(entity_manager_t* entity_manager, entity_t entity, entity_resource_t resource);
+void movement_system(entity_manager_t* entity_manager, float dt);
+void update_ball(entity_manager_t* entity_manager, entity_t ball, entity_t paddles[2]);
+void update_paddle(entity_manager_t* entity_manager, entity_t paddle);
+
+#endif